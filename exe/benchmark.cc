@@ -1,19 +1,30 @@
 #include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <regex>
 
 #include "boost/program_options.hpp"
 
 #include "utl/parallel_for.h"
 #include "utl/progress_tracker.h"
+#include "utl/verify.h"
 
+#include "nigiri/common/event_time_search.h"
+#include "nigiri/common/linear_lower_bound.h"
+#include "nigiri/common/memory_usage.h"
+#include "nigiri/common/parse_date.h"
+#include "nigiri/loader/compress_route_stop_times.h"
 #include "nigiri/logging.h"
+#include "nigiri/mapped_timetable.h"
 #include "nigiri/qa/qa.h"
 #include "nigiri/query_generator/generator.h"
+#include "nigiri/routing/raptor/active_transports.h"
 #include "nigiri/routing/raptor/raptor.h"
 #include "nigiri/routing/raptor_search.h"
 #include "nigiri/routing/search.h"
+#include "nigiri/routing/tb/preprocess.h"
+#include "nigiri/routing/tb/tb_search.h"
 #include "nigiri/timetable.h"
 #include "nigiri/types.h"
 
@@ -305,6 +316,228 @@ void print_results(
   print_result(results, "#journeys");
 }
 
+// Compares the scalar linear search with the vectorized search for the first
+// reachable departure at every route stop of the timetable.
+void bench_event_search(timetable const& tt) {
+  using namespace std::chrono;
+
+  constexpr auto const kKeyStep = 30;
+  auto const run = [&](auto&& fn) {
+    auto checksum = std::size_t{0U};
+    auto n_calls = std::size_t{0U};
+    auto buf = std::vector<delta>{};
+    auto const start = steady_clock::now();
+    for (auto i = 0U; i != tt.n_routes(); ++i) {
+      auto const r = route_idx_t{i};
+      auto const n_stops =
+          static_cast<stop_idx_t>(tt.route_location_seq_[r].size());
+      for (auto s = stop_idx_t{0U}; s < n_stops - 1U; ++s) {
+        auto const events =
+            tt.event_times_at_stop(r, s, event_type::kDep, buf);
+        for (auto key = std::int16_t{0}; key < 1440; key += kKeyStep) {
+          checksum += fn(events, key);
+          ++n_calls;
+        }
+      }
+    }
+    auto const stop = steady_clock::now();
+    return std::tuple{
+        static_cast<double>(duration_cast<nanoseconds>(stop - start).count()) /
+            static_cast<double>(std::max(n_calls, std::size_t{1U})),
+        checksum, n_calls};
+  };
+
+  auto const [scalar_ns, scalar_checksum, n_calls] =
+      run([](std::span<delta const> events, std::int16_t const key) {
+        return static_cast<std::size_t>(
+            linear_lb(begin(events), end(events), key,
+                      [](delta const a, std::int16_t const b) {
+                        return a.mam() < b;
+                      }) -
+            begin(events));
+      });
+  auto const [simd_ns, simd_checksum, simd_n_calls] =
+      run([](std::span<delta const> events, std::int16_t const key) {
+        return n_unreachable_events<direction::kForward>(events, key);
+      });
+
+  utl::verify(scalar_checksum == simd_checksum && n_calls == simd_n_calls,
+              "event search mismatch: scalar={}, simd={}", scalar_checksum,
+              simd_checksum);
+  std::cout << "--- earliest transport search (" << n_calls << " calls) ---\n"
+            << "scalar: " << scalar_ns << "ns/call\n"
+            << "simd:   " << simd_ns << "ns/call\n";
+
+  // Cost of event_times_at_stop() itself (decoding if compressed).
+  auto n_events = std::size_t{0U};
+  auto n_lookups = std::size_t{0U};
+  auto buf = std::vector<delta>{};
+  auto const start = steady_clock::now();
+  for (auto i = 0U; i != tt.n_routes(); ++i) {
+    auto const r = route_idx_t{i};
+    auto const n_stops =
+        static_cast<stop_idx_t>(tt.route_location_seq_[r].size());
+    for (auto s = stop_idx_t{0U}; s < n_stops - 1U; ++s) {
+      n_events += tt.event_times_at_stop(r, s, event_type::kDep, buf).size();
+      ++n_lookups;
+    }
+  }
+  auto const stop = steady_clock::now();
+  std::cout << "event_times_at_stop ("
+            << (tt.has_compressed_stop_times() ? "compressed" : "plain")
+            << ", " << n_events << " events): "
+            << static_cast<double>(
+                   duration_cast<nanoseconds>(stop - start).count()) /
+                   static_cast<double>(std::max(n_lookups, std::size_t{1U}))
+            << "ns/call\n";
+}
+
+void bench_active_transports(timetable const& tt) {
+  using namespace std::chrono;
+
+  constexpr auto const kDays = 7U;
+  auto const first_day = static_cast<std::size_t>(kTimetableOffset.count());
+  auto const run = [&](auto&& fn) {
+    auto n_active = std::size_t{0U};
+    auto const start = steady_clock::now();
+    for (auto day = first_day; day != first_day + kDays; ++day) {
+      for (auto i = 0U; i != tt.n_routes(); ++i) {
+        n_active += fn(route_idx_t{i}, day);
+      }
+    }
+    auto const stop = steady_clock::now();
+    auto const n_checked = tt.transport_traffic_days_.size() * kDays;
+    return std::pair{
+        static_cast<double>(duration_cast<nanoseconds>(stop - start).count()) /
+            static_cast<double>(std::max(n_checked, std::size_t{1U})),
+        n_active};
+  };
+
+  auto const [bitfield_ns, bitfield_active] =
+      run([&](route_idx_t const r, std::size_t const day) {
+        auto n = std::size_t{0U};
+        for (auto const t : tt.route_transport_ranges_[r]) {
+          n += tt.is_traffic_day(tt.transport_traffic_days_[t], day) ? 1U : 0U;
+        }
+        return n;
+      });
+
+  auto at = active_transports{};
+  auto const scan = [&](route_idx_t const r, std::size_t const day) {
+    auto const transports = tt.route_transport_ranges_[r];
+    auto n = std::size_t{0U};
+    for (auto t = at.first_active(tt, r, transports.from_, transports.to_, day);
+         t != transports.to_;
+         t = at.first_active(tt, r, transport_idx_t{to_idx(t) + 1U},
+                             transports.to_, day)) {
+      ++n;
+    }
+    return n;
+  };
+  at.days_.reserve(active_transports::kMaxCachedDays);
+  auto const [build_ns, build_active] = run(scan);
+  auto const [scan_ns, scan_active] = run(scan);
+
+  utl::verify(bitfield_active == build_active && bitfield_active == scan_active,
+              "active transports mismatch: bitfields={}, index={}/{}",
+              bitfield_active, build_active, scan_active);
+  std::cout << "--- active transports (" << kDays << " days, "
+            << bitfield_active << " active) ---\n"
+            << "bitfields:          " << bitfield_ns << "ns/transport\n"
+            << "index (with build): " << build_ns << "ns/transport\n"
+            << "index (cached):     " << scan_ns << "ns/transport\n";
+}
+
+void bench_tb(
+    timetable const& tt,
+    std::vector<nigiri::query_generation::start_dest_query> const& queries,
+    profile_idx_t const prf_idx,
+    std::filesystem::path const& tb_path) {
+  using namespace std::chrono;
+
+  auto wrapped_tbd = std::optional<cista::wrapped<tb::tb_data>>{};
+  auto computed_tbd = std::optional<tb::tb_data>{};
+  if (!tb_path.empty() && std::filesystem::is_regular_file(tb_path)) {
+    wrapped_tbd.emplace(tb::tb_data::read(tb_path));
+  } else {
+    computed_tbd.emplace(tb::preprocess(tt, prf_idx));
+    if (!tb_path.empty()) {
+      computed_tbd->write(tb_path);
+    }
+  }
+  auto const& tbd = wrapped_tbd.has_value() ? **wrapped_tbd : *computed_tbd;
+
+  auto const criteria = [](pareto_set<journey> const& journeys) {
+    auto c = std::vector<std::tuple<unixtime_t, unixtime_t, std::uint8_t>>{};
+    for (auto const& j : journeys) {
+      c.emplace_back(j.start_time_, j.dest_time_, j.transfers_);
+    }
+    utl::sort(c);
+    return c;
+  };
+
+  auto s_state = search_state{};
+  auto r_state = raptor_state{};
+  auto q_state = tb::query_state{tbd};
+  auto raptor_time = nanoseconds{0};
+  auto tb_time = nanoseconds{0};
+  auto n_mismatches = 0U;
+  auto n_failed = 0U;
+  for (auto const& q : queries) {
+    try {
+      auto const raptor_start = steady_clock::now();
+      auto const raptor_result = routing::raptor_search(
+          tt, nullptr, s_state, r_state, q.q_, direction::kForward);
+      auto const raptor_criteria = criteria(*raptor_result.journeys_);
+      auto const tb_start = steady_clock::now();
+      auto const tb_result = tb::tb_search(tt, s_state, q_state, q.q_);
+      auto const tb_criteria = criteria(*tb_result.journeys_);
+      auto const tb_stop = steady_clock::now();
+
+      raptor_time += tb_start - raptor_start;
+      tb_time += tb_stop - tb_start;
+      n_mismatches += raptor_criteria != tb_criteria ? 1U : 0U;
+    } catch (std::exception const& e) {
+      std::cout << e.what() << "\n";
+      ++n_failed;
+    }
+  }
+
+  auto const n = static_cast<double>(
+      std::max(queries.size() - n_failed, std::size_t{1U}));
+  std::cout << "--- trip-based routing (" << queries.size() << " queries, "
+            << n_failed << " failed) ---\n"
+            << "raptor: "
+            << static_cast<double>(
+                   duration_cast<microseconds>(raptor_time).count()) /
+                   n / 1000.0
+            << "ms/query\n"
+            << "tb:     "
+            << static_cast<double>(
+                   duration_cast<microseconds>(tb_time).count()) /
+                   n / 1000.0
+            << "ms/query\n"
+            << "mismatches: " << n_mismatches << "\n";
+}
+
+void print_stop_times_size(timetable const& tt) {
+  auto const mib = [](auto const& v) {
+    return static_cast<double>(v.size() * sizeof(*v.data())) / (1024 * 1024);
+  };
+  if (tt.has_compressed_stop_times()) {
+    std::cout << "compressed stop times: "
+              << mib(tt.compressed_first_dep_) +
+                     mib(tt.compressed_profile_idx_) +
+                     mib(tt.compressed_route_profiles_) +
+                     mib(tt.compressed_profiles_)
+              << " MiB\n";
+  } else {
+    std::cout << "stop times: "
+              << mib(tt.route_stop_times_) + mib(tt.route_stop_time_ranges_)
+              << " MiB\n";
+  }
+}
+
 void print_memory_usage() {
 #ifndef _WIN32
   auto r = rusage{};
@@ -335,6 +568,12 @@ int main(int argc, char* argv[]) {
   auto seed = std::int64_t{-1};
   auto min_transfer_time = duration_t::rep{};
   auto qa_path = std::filesystem::path{};
+  auto read_opt = timetable_read_options{};
+  auto use_mmap = false;
+  auto window_from_str = std::string{};
+  auto window_days = 15U;
+  auto compress_stop_times = false;
+  auto tb_path = std::filesystem::path{};
 
   bpo::options_description desc("Allowed options");
   desc.add_options()("help,h", "produce this help message")  //
@@ -408,7 +647,30 @@ int main(int argc, char* argv[]) {
       ("dest_loc", bpo::value<location_idx_t::value_t>(&dest_loc_val),
        "destination location for random queries")  //
       ("qa_path,q", bpo::value(&qa_path),
-       "path to write the journey criteria to for qa");
+       "path to write the journey criteria to for qa")  //
+      ("bench_event_search",
+       "only benchmark the earliest transport search kernel")  //
+      ("bench_active_transports",
+       "only benchmark the active transports index against the bitfields")  //
+      ("huge_pages", bpo::bool_switch(&read_opt.huge_pages_),
+       "back the timetable with transparent huge pages")  //
+      ("prefault", bpo::bool_switch(&read_opt.prefault_),
+       "fault in the routing data while loading the timetable (only with "
+       "--mmap, reading the file already faults in all pages)")  //
+      ("mlock", bpo::bool_switch(&read_opt.lock_),
+       "lock the routing data in memory (needs RLIMIT_MEMLOCK)")  //
+      ("mmap", bpo::bool_switch(&use_mmap),
+       "map the timetable file read-only (shared between processes)")  //
+      ("window_from", bpo::value(&window_from_str),
+       "only load days starting from this date (YYYY-MM-DD or TODAY)")  //
+      ("window_days", bpo::value(&window_days)->default_value(window_days),
+       "number of days to load, starting at window_from")  //
+      ("compress_stop_times", bpo::bool_switch(&compress_stop_times),
+       "compress the stop times after loading (see nigiri-import)")  //
+      ("tb", "only compare trip-based routing with RAPTOR on the queries")  //
+      ("tb_path", bpo::value(&tb_path),
+       "trip-based transfer set: loaded if the file exists, otherwise "
+       "computed and written there");
   bpo::variables_map vm;
   bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
 
@@ -420,9 +682,50 @@ int main(int argc, char* argv[]) {
 
   bpo::notify(vm);
 
+  if (!window_from_str.empty()) {
+    auto const from = parse_date(window_from_str);
+    read_opt.date_window_ = {from, from + date::days{window_days}};
+  }
+
   std::cout << "loading timetable...\n";
-  auto tt = *nigiri::timetable::read(tt_path);
-  tt.locations_.resolve_timezones();
+  auto const read_start = std::chrono::steady_clock::now();
+  auto wrapped_tt = std::optional<cista::wrapped<timetable>>{};
+  auto mapped_tt = std::optional<mapped_timetable>{};
+  if (use_mmap) {
+    mapped_tt.emplace(tt_path, read_opt);
+  } else {
+    wrapped_tt.emplace(timetable::read(tt_path, read_opt));
+    (*wrapped_tt)->locations_.resolve_timezones();
+  }
+  if (compress_stop_times) {
+    utl::verify(!use_mmap, "compress_stop_times: not possible with mmap");
+    if (!(*wrapped_tt)->has_compressed_stop_times()) {
+      loader::compress_route_stop_times(**wrapped_tt);
+    }
+  }
+  auto const& tt = use_mmap ? **mapped_tt : **wrapped_tt;
+  auto const read_stop = std::chrono::steady_clock::now();
+  auto const mem = get_memory_usage();
+  print_stop_times_size(tt);
+  std::cout << "loaded in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   read_stop - read_start)
+                   .count()
+            << "ms, rss: " << (mem.current_rss_ >> 20U)
+            << " MiB (huge_pages=" << read_opt.huge_pages_
+            << ", prefault=" << (read_opt.prefault_ && use_mmap)
+            << ", mlock=" << read_opt.lock_ << ", mmap=" << use_mmap
+            << ")\n";
+
+  if (vm.count("bench_event_search") != 0U) {
+    bench_event_search(tt);
+    return 0;
+  }
+
+  if (vm.count("bench_active_transports") != 0U) {
+    bench_active_transports(tt);
+    return 0;
+  }
 
   gs.interval_size_ = duration_t{interval_size};
 
@@ -524,6 +827,11 @@ int main(int argc, char* argv[]) {
   auto queries = std::vector<nigiri::query_generation::start_dest_query>{};
   generate_queries(queries, n_queries, tt, gs, seed);
 
+  if (vm.count("tb") != 0U) {
+    bench_tb(tt, queries, gs.prf_idx_, tb_path);
+    return 0;
+  }
+
   auto results = std::vector<benchmark_result>{};
   process_queries(queries, results, tt);
 
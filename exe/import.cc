@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <fstream>
+#include <new>
 #include <vector>
 
 #include "boost/algorithm/string.hpp"
@@ -9,8 +12,11 @@
 
 #include "nigiri/loader/load.h"
 #include "nigiri/loader/loader_interface.h"
+#include "nigiri/common/memory_usage.h"
 #include "nigiri/common/parse_date.h"
+#include "nigiri/logging.h"
 #include "nigiri/shapes_storage.h"
+#include "nigiri/timetable_cold_data.h"
 
 namespace fs = std::filesystem;
 namespace bpo = boost::program_options;
@@ -18,6 +24,19 @@ using namespace nigiri;
 using namespace nigiri::loader;
 using namespace std::string_literals;
 
+// Counts allocations for the stage report (only with --stage_report).
+void* operator new(std::size_t const size) {
+  nigiri::count_allocation(size);
+  if (auto* const ptr = std::malloc(size == 0U ? 1U : size); ptr != nullptr) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
 int main(int ac, char** av) {
   auto const progress_tracker = utl::activate_progress_tracker("importer");
   auto const silencer = utl::global_progress_bars{true};
@@ -25,11 +44,13 @@ int main(int ac, char** av) {
   auto in = fs::path{};
   auto out = fs::path{"tt.bin"};
   auto out_shapes = fs::path{"shapes"};
+  auto out_cold = fs::path{};
   auto start_date = "TODAY"s;
   auto assistance_path = fs::path{};
   auto n_days = 365U;
   auto recursive = false;
   auto ignore = false;
+  auto stage_report_path = fs::path{};
 
   auto finalize_opt = finalize_options{};
   auto c = loader_config{};
@@ -67,8 +88,36 @@ int main(int ac, char** av) {
       ("max_foopath_length",
        bpo::value(&finalize_opt.max_footpath_length_)
            ->default_value(finalize_opt.max_footpath_length_))  //
+      ("reorder_locations",
+       bpo::value(&finalize_opt.reorder_locations_)
+           ->default_value(finalize_opt.reorder_locations_),
+       "renumber locations along a space filling curve for memory locality")  //
+      ("reorder_routes",
+       bpo::value(&finalize_opt.reorder_routes_)
+           ->default_value(finalize_opt.reorder_routes_),
+       "renumber routes along a space filling curve for memory locality")  //
+      ("frequency_runs",
+       bpo::value(&finalize_opt.build_frequency_runs_)
+           ->default_value(finalize_opt.build_frequency_runs_),
+       "detect runs of transports with a constant headway (frequencies) to "
+       "speed up routing")  //
+      ("compress_stop_times",
+       bpo::value(&finalize_opt.compress_route_stop_times_)
+           ->default_value(finalize_opt.compress_route_stop_times_),
+       "store stop times as per-route profiles (less memory, slower "
+       "access)")  //
+      ("compress_bitfields",
+       bpo::value(&finalize_opt.compress_bitfields_)
+           ->default_value(finalize_opt.compress_bitfields_),
+       "store traffic days as weekday pattern + exceptions (less memory, "
+       "slower access)")  //
       ("assistance_times", bpo::value(&assistance_path))  //
-      ("shapes", bpo::value(&out_shapes));
+      ("shapes", bpo::value(&out_shapes))  //
+      ("cold", bpo::value(&out_cold),
+       "write metadata not needed for routing (debug info, display names) "
+       "to this file instead of the output timetable")  //
+      ("stage_report", bpo::value(&stage_report_path),
+       "write per-stage timing, RSS and allocation counts as JSON");
   auto const pos = bpo::positional_options_description{}.add("in", -1);
 
   auto vm = bpo::variables_map{};
@@ -112,8 +161,26 @@ int main(int ac, char** av) {
                                               cista::mmap::protection::WRITE);
   }
 
+  if (vm.contains("stage_report")) {
+    enable_allocation_counting();
+    enable_stage_report();
+  }
+
   auto const start = parse_date(start_date);
-  load(input_files, finalize_opt, {start, start + date::days{n_days}},
-       assistance.get(), shapes.get(), ignore && recursive)
-      .write(out);
+  {
+    auto tt =
+        load(input_files, finalize_opt, {start, start + date::days{n_days}},
+             assistance.get(), shapes.get(), ignore && recursive);
+    auto const timer = scoped_timer{"import.write"};
+    if (vm.contains("cold")) {
+      write_hot_cold(tt, out, out_cold);
+    } else {
+      tt.write(out);
+    }
+  }
+
+  if (vm.contains("stage_report")) {
+    auto f = std::ofstream{stage_report_path};
+    write_stage_report(f);
+  }
 }
\ No newline at end of file
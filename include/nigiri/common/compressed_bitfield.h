@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+
+// Compact encoding of a traffic day bitfield:
+//   - [from_, to_[ = range between the first and the last active day
+//   - weekdays_ = bit (day % 7) is set if the day is active by default
+//   - exceptions_ = sorted list of days in the range deviating from weekdays_
+// A typical "Mon-Fri for one year except holidays" service needs a few bytes
+// instead of the 64 bytes of a full bitfield.
+struct compressed_bitfield {
+  CISTA_COMPARABLE()
+
+  static compressed_bitfield compress(bitfield const&);
+  bitfield decompress() const;
+
+  bool test(std::size_t const day) const {
+    if (day < from_ || day >= to_) {
+      return false;
+    }
+    auto const by_pattern = ((weekdays_ >> (day % 7U)) & 1U) != 0U;
+    return exceptions_.empty() ? by_pattern : by_pattern != is_exception(day);
+  }
+
+  bool is_exception(std::size_t day) const;
+  bool empty() const { return from_ == to_; }
+  std::size_t count() const;
+
+  // Including the vector header and the heap allocation of exceptions_.
+  std::size_t size_bytes() const;
+
+  std::uint16_t from_{0U}, to_{0U};
+  std::uint8_t weekdays_{0U};
+  vector<std::uint16_t> exceptions_;
+};
+
+// Compressed bitfields stored column-wise: the exception lists of all
+// entries share one array, so there is no allocation (and no vector header)
+// per entry. Used by timetable::compressed_bitfields_.
+struct compressed_bitfields {
+  struct entry {
+    std::uint16_t from_{0U}, to_{0U};
+    std::uint8_t weekdays_{0U};
+  };
+
+  bitfield_idx_t add(compressed_bitfield const& c) {
+    auto const idx = bitfield_idx_t{entries_.size()};
+    entries_.push_back(entry{c.from_, c.to_, c.weekdays_});
+    exceptions_.emplace_back(c.exceptions_);
+    return idx;
+  }
+
+  bool test(bitfield_idx_t const i, std::size_t const day) const {
+    auto const& e = entries_[i];
+    if (day < e.from_ || day >= e.to_) {
+      return false;
+    }
+    auto const by_pattern = ((e.weekdays_ >> (day % 7U)) & 1U) != 0U;
+    auto const ex = exceptions_[i];
+    return ex.empty() ? by_pattern
+                      : by_pattern != std::binary_search(
+                                          ex.begin(), ex.end(),
+                                          static_cast<std::uint16_t>(day));
+  }
+
+  bitfield get(bitfield_idx_t) const;
+  std::size_t size() const { return entries_.size(); }
+  std::size_t size_bytes() const;
+
+  vector_map<bitfield_idx_t, entry> entries_;
+  vecvec<bitfield_idx_t, std::uint16_t> exceptions_;
+};
+
+}  // namespace nigiri
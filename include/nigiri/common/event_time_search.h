@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <span>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+
+// Number of events that cannot be reached given the time at the stop
+// (minutes after midnight) - ignoring the day offset of the events:
+//   - forward: leading events with mam < key (= index of first mam >= key)
+//   - backward: trailing events with mam > key (= reverse index of the last
+//     event with mam <= key)
+// Equivalent to linear_lb over (r)begin/(r)end of the event times.
+// Vectorized with AVX2 (16 events) or SSE2 (8 events) if available.
+template <direction SearchDir>
+std::size_t n_unreachable_events(std::span<delta const> events,
+                                 std::int16_t const key) {
+  constexpr auto const kFwd = SearchDir == direction::kForward;
+
+  // delta = [days_: 5 bits | mam_: 11 bits] starting from the lowest bit
+  auto const* data = reinterpret_cast<std::uint16_t const*>(events.data());
+  auto const n = events.size();
+  auto i = std::size_t{0U};
+
+  // Forward: first lane with mam > key - 1
+  // Backward: last lane with key + 1 > mam
+  auto const cmp_key = static_cast<std::int16_t>(kFwd ? key - 1 : key + 1);
+
+  auto const first_match = [&](unsigned const mask, std::size_t const block) {
+    if constexpr (kFwd) {
+      return block + static_cast<std::size_t>(std::countr_zero(mask)) / 2U;
+    } else {
+      auto const lane =
+          static_cast<std::size_t>(31 - std::countl_zero(mask)) / 2U;
+      return n - (block + lane) - 1U;
+    }
+  };
+
+#if defined(__AVX2__)
+  auto const key_v = _mm256_set1_epi16(cmp_key);
+  for (; i + 16U <= n; i += 16U) {
+    auto const block = kFwd ? i : n - i - 16U;
+    auto const mam = _mm256_srli_epi16(
+        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + block)), 5);
+    auto const match = kFwd ? _mm256_cmpgt_epi16(mam, key_v)
+                            : _mm256_cmpgt_epi16(key_v, mam);
+    auto const mask = static_cast<unsigned>(_mm256_movemask_epi8(match));
+    if (mask != 0U) {
+      return first_match(mask, block);
+    }
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  auto const key_v = _mm_set1_epi16(cmp_key);
+  for (; i + 8U <= n; i += 8U) {
+    auto const block = kFwd ? i : n - i - 8U;
+    auto const mam = _mm_srli_epi16(
+        _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + block)), 5);
+    auto const match =
+        kFwd ? _mm_cmpgt_epi16(mam, key_v) : _mm_cmpgt_epi16(key_v, mam);
+    auto const mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+    if (mask != 0U) {
+      return first_match(mask, block);
+    }
+  }
+#else
+  (void)data;
+  (void)cmp_key;
+  (void)first_match;
+#endif
+
+  for (; i != n; ++i) {
+    auto const mam = events[kFwd ? i : n - i - 1U].mam();
+    if (kFwd ? mam >= key : mam <= key) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// Same as n_unreachable_events for the n events of one frequency run:
+// e_j = e_0 + j * headway. `first` is the first event in search direction
+// (forward: e_0, backward: e_{n-1}). Steps over whole days at once.
+template <direction SearchDir>
+std::size_t n_unreachable_events_in_run(delta const first,
+                                        std::uint16_t const headway,
+                                        std::size_t const n,
+                                        std::int16_t const key) {
+  constexpr auto const kFwd = SearchDir == direction::kForward;
+
+  auto const div_ceil = [](int const a, int const b) {
+    return (a + b - 1) / b;
+  };
+  auto const h = static_cast<int>(headway);
+  auto mam = static_cast<int>(first.mam());
+  auto i = std::size_t{0U};
+  while (i < n) {
+    if (kFwd ? mam >= key : mam <= key) {
+      return i;
+    }
+    auto const to_key = div_ceil(kFwd ? key - mam : mam - key, h);
+    auto const to_midnight = kFwd ? div_ceil(1440 - mam, h) : mam / h + 1;
+    if (to_key < to_midnight) {
+      return std::min(n, i + static_cast<std::size_t>(to_key));
+    }
+    i += static_cast<std::size_t>(to_midnight);
+    mam += kFwd ? to_midnight * h - 1440 : 1440 - to_midnight * h;
+  }
+  return n;
+}
+
+// n_unreachable_events for a route partitioned into frequency runs.
+// event_at(i) returns event i. Only the first event (in search direction) of
+// each run visited is read, so events can be computed on demand instead of
+// decoding all n events.
+template <direction SearchDir, typename Runs, typename EventAt>
+std::size_t n_unreachable_events(std::size_t const n,
+                                 Runs const& runs,
+                                 std::int16_t const key,
+                                 EventAt&& event_at) {
+  if constexpr (SearchDir == direction::kForward) {
+    for (auto const& run : runs) {
+      auto const i = n_unreachable_events_in_run<SearchDir>(
+          event_at(run.from_), run.headway_, run.n_, key);
+      if (i != run.n_) {
+        return run.from_ + i;
+      }
+    }
+  } else {
+    for (auto j = runs.size(); j != 0U; --j) {
+      auto const& run = runs[j - 1U];
+      auto const i = n_unreachable_events_in_run<SearchDir>(
+          event_at(run.from_ + run.n_ - 1U), run.headway_, run.n_, key);
+      if (i != run.n_) {
+        return n - (run.from_ + run.n_) + i;
+      }
+    }
+  }
+  return n;
+}
+
+template <direction SearchDir, typename Runs>
+std::size_t n_unreachable_events(std::span<delta const> events,
+                                 Runs const& runs,
+                                 std::int16_t const key) {
+  return n_unreachable_events<SearchDir>(
+      events.size(), runs, key,
+      [&](std::size_t const i) { return events[i]; });
+}
+
+}  // namespace nigiri
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace nigiri {
+
+/*
+ * Snapshot of the process memory usage.
+ * current_rss_ / peak_rss_ are in bytes (0 if not supported on this platform).
+ * n_allocations_ / allocated_bytes_ are only counted if the executable
+ * forwards its allocations to count_allocation() (see nigiri-import).
+ */
+struct memory_usage {
+  std::size_t current_rss_{0U};
+  std::size_t peak_rss_{0U};
+  std::uint64_t n_allocations_{0U};
+  std::uint64_t allocated_bytes_{0U};
+};
+
+struct allocation_counters {
+  std::atomic_bool enabled_{false};
+  std::atomic_uint64_t n_allocations_{0U};
+  std::atomic_uint64_t allocated_bytes_{0U};
+};
+
+allocation_counters& get_allocation_counters();
+
+// count_allocation() is a no-op until this is called.
+void enable_allocation_counting();
+
+inline void count_allocation(std::size_t const size) {
+  auto& c = get_allocation_counters();
+  if (!c.enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  c.n_allocations_.fetch_add(1U, std::memory_order_relaxed);
+  c.allocated_bytes_.fetch_add(size, std::memory_order_relaxed);
+}
+
+memory_usage get_memory_usage();
+
+// Resets the peak RSS of the process to the current RSS (Linux: writes 5 to
+// /proc/self/clear_refs). Returns false if this is not supported.
+bool reset_peak_rss();
+
+}  // namespace nigiri
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+namespace nigiri {
+
+/*
+ * Memory hints for large read-only data (e.g. a deserialized timetable).
+ * All functions operate on the pages overlapping [data, data + size).
+ * They are best effort: on platforms without madvise/mlock they do nothing
+ * and return false.
+ */
+
+// Requests transparent huge pages (Linux: MADV_HUGEPAGE) for the pages fully
+// contained in the range. Has to be called before the pages are touched.
+bool advise_huge_pages(void const* data, std::size_t size);
+
+// Faults in all pages now instead of on first access (MADV_WILLNEED + one
+// read per page).
+bool prefault_pages(void const* data, std::size_t size);
+
+// Pins the pages in memory (mlock). Fails if RLIMIT_MEMLOCK is too low.
+bool lock_pages(void const* data, std::size_t size);
+
+}  // namespace nigiri
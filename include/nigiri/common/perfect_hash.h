@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+
+// Minimal perfect hash map from 64bit key hashes to 32bit values
+// (hash and displace). Keys are split into ~n/2 buckets, each bucket stores
+// the seed that places all its keys into distinct slots of a table with
+// exactly one slot per key. A lookup costs one multiply-xorshift mix and two
+// array accesses.
+//
+// The keys are not stored: find() returns an arbitrary value for hashes
+// that were not part of build(). Callers have to verify the result.
+struct perfect_hash_index {
+  static std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30U;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27U;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31U;
+    return x;
+  }
+
+  // Returns false and leaves the index empty if two hashes are equal (or no
+  // seed places a bucket). Callers then need a different lookup.
+  bool build(std::vector<std::pair<std::uint64_t, std::uint32_t>> const&);
+
+  bool empty() const { return values_.empty(); }
+  std::size_t size() const { return values_.size(); }
+
+  std::uint32_t find(std::uint64_t const h) const {
+    auto const seed = seeds_[bucket(h)];
+    return values_[slot(h, seed)];
+  }
+
+  std::size_t bucket(std::uint64_t const h) const {
+    return (h >> 32U) % seeds_.size();
+  }
+
+  std::size_t slot(std::uint64_t const h, std::uint32_t const seed) const {
+    return mix(h ^ (seed * 0x9E3779B97F4A7C15ULL)) % values_.size();
+  }
+
+  vector<std::uint32_t> seeds_;
+  vector<std::uint32_t> values_;
+};
+
+}  // namespace nigiri
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cinttypes>
+#include <string_view>
+#include <utility>
+
+#include "utl/get_or_create.h"
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+
+using string_idx_t = cista::strong<std::uint32_t, struct _string_idx>;
+
+// Strings indexed by Key where many keys share the same string (e.g. stop
+// names or trip display names like "Bus 42"). Each key maps to an index into
+// the string pool, so access stays O(1) with one extra indirection.
+// emplace_back() appends without lookup (cheap during loading), compact()
+// drops duplicates from the pool afterwards.
+template <typename Key>
+struct string_store {
+  auto operator[](Key const k) const { return strings_[idx_[k]]; }
+  auto at(Key const k) const { return strings_.at(idx_.at(k)); }
+
+  std::size_t size() const { return idx_.size(); }
+  bool empty() const { return idx_.empty(); }
+
+  template <typename T>
+  void emplace_back(T&& s) {
+    idx_.emplace_back(string_idx_t{strings_.size()});
+    strings_.emplace_back(std::forward<T>(s));
+  }
+
+  // Stores every distinct string only once. Keys are not changed.
+  void compact() {
+    auto unique = hash_map<std::string_view, string_idx_t>{};
+    auto strings = vecvec<string_idx_t, char>{};
+    auto idx = vector_map<Key, string_idx_t>{};
+    idx.reserve(idx_.size());
+    for (auto const i : idx_) {
+      auto const s = strings_[i].view();
+      idx.emplace_back(utl::get_or_create(unique, s, [&]() {
+        auto const next = string_idx_t{strings.size()};
+        strings.emplace_back(s);
+        return next;
+      }));
+    }
+    idx_ = std::move(idx);
+    strings_ = std::move(strings);
+  }
+
+  void clear() {
+    idx_.clear();
+    strings_.clear();
+  }
+
+  vector_map<Key, string_idx_t> idx_;
+  vecvec<string_idx_t, char> strings_;
+};
+
+}  // namespace nigiri
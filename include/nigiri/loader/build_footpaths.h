@@ -9,8 +9,20 @@ struct finalize_options {
   bool merge_dupes_intra_src_{true};
   bool merge_dupes_inter_src_{true};
   std::uint16_t max_footpath_length_{20U};
+  bool reorder_locations_{false};
+  bool reorder_routes_{false};
+  bool compress_route_stop_times_{false};
+  bool build_frequency_runs_{false};
+  bool compress_bitfields_{false};
 };
 
 void build_footpaths(timetable& tt, finalize_options);
 
+// Converts profiles != 0 that are full copies of the footpath graph into
+// overrides of profile 0: only locations whose footpaths differ from
+// profile 0 keep their own footpaths (see has_own_footpaths_out_). Has to be
+// called after all profiles are written. To replace the footpaths of a
+// deduplicated profile later, clear its has_own_footpaths_* first.
+void deduplicate_footpath_profiles(timetable&);
+
 }  // namespace nigiri::loader
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace nigiri {
+struct timetable;
+}  // namespace nigiri
+
+namespace nigiri::loader {
+
+// Partitions the transports of every route into frequency runs (identical
+// travel times, constant headway) and stores them in
+// tt.route_frequency_runs_ for routes where runs are long on average (e.g.
+// expanded GTFS frequencies). Routing then finds the first reachable
+// departure of such routes arithmetically per run instead of scanning all
+// event times. Transports stay materialized (reconstruction and real-time
+// updates are unchanged).
+void build_frequency_runs(timetable&);
+
+}  // namespace nigiri::loader
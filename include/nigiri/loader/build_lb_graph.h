@@ -26,9 +26,9 @@ void build_lb_graph(timetable& tt, profile_idx_t const prf_idx = 0) {
                               ? l
                               : tt.locations_.parents_[l];
 
-    auto const& footpaths = SearchDir == direction::kForward
-                                ? tt.locations_.footpaths_in_[prf_idx][l]
-                                : tt.locations_.footpaths_out_[prf_idx][l];
+    auto const footpaths = SearchDir == direction::kForward
+                               ? tt.locations_.footpaths_in(prf_idx, l)
+                               : tt.locations_.footpaths_out(prf_idx, l);
     for (auto const& fp : footpaths) {
       auto const parent = tt.locations_.parents_[fp.target()];
       auto const target =
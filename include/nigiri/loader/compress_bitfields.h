@@ -0,0 +1,15 @@
+#pragma once
+
+namespace nigiri {
+struct timetable;
+}  // namespace nigiri
+
+namespace nigiri::loader {
+
+// Replaces bitfields_ by compressed_bitfields_ (see compressed_bitfield.h).
+// Duplicate bitfields are merged, all bitfield indices (transports, trip
+// services, booking rules) are remapped. Has to be the last step
+// registering bitfields.
+void compress_bitfields(timetable&);
+
+}  // namespace nigiri::loader
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace nigiri {
+struct timetable;
+}  // namespace nigiri
+
+namespace nigiri::loader {
+
+// Replaces route_stop_times_ by the compressed representation (first
+// departure + stop time profile per transport, see timetable.h). Routes
+// with regular services (e.g. the same travel times every 10 minutes) only
+// store one profile instead of the event times of every transport.
+// Has to be the last step modifying transports or routes.
+void compress_route_stop_times(timetable&);
+
+}  // namespace nigiri::loader
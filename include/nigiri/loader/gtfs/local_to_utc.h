@@ -124,12 +124,28 @@ struct conversion_key {
   duration_t tz_offset_;
 };
 
+// Everything the UTC day-shift partitioning of a trip depends on.
+// Trips with the same signature get the same partitions (conversion key ->
+// UTC traffic days), so they are computed only once per source.
+struct utc_conversion_signature {
+  CISTA_FRIEND_COMPARABLE(utc_conversion_signature)
+  timezone_idx_t tz_;
+  duration_t first_dep_time_;
+  duration_t last_arr_time_;
+  bitfield traffic_days_;
+};
+
+using utc_partitions_t = std::vector<pair<conversion_key, bitfield>>;
+using local_to_utc_cache =
+    hash_map<utc_conversion_signature, utc_partitions_t>;
+
 template <typename Consumer>
 void expand_local_to_utc(trip_data const& trip_data,
                          noon_offset_hours_t const& noon_offsets,
                          timetable const& tt,
                          frequency_expanded_trip&& fet,
                          interval<date::sys_days> const& selection,
+                         local_to_utc_cache& cache,
                          Consumer&& consumer) {
   auto const tt_interval = tt.internal_interval_days();
   auto trip_it = begin(fet.trips_);
@@ -163,48 +179,64 @@ void expand_local_to_utc(trip_data const& trip_data,
       fet.offsets_.back();
   auto const first_day_offset = (first_dep_time / 1_days) * date::days{1};
   auto const last_day_offset = (last_arr_time / 1_days) * date::days{1};
+  auto const tz =
+      tt.providers_[trip_data.get(fet.trips_.front()).route_->agency_].tz_;
 
-  auto utc_time_traffic_days = hash_map<conversion_key, bitfield>{};
-  auto prev_key = conversion_key{date::days{2}, duration_t{-1}};
-  auto prev_it = utc_time_traffic_days.end();
-  for (auto day = tt_interval.from_; day != tt_interval.to_;
-       day += date::days{1}) {
-    auto const service_days =
-        interval{day + first_day_offset, day + last_day_offset + date::days{1}};
-    if (!selection.overlaps(service_days)) {
-      continue;
-    }
+  auto const compute_partitions = [&]() {
+    auto utc_time_traffic_days = hash_map<conversion_key, bitfield>{};
+    auto prev_key = conversion_key{date::days{2}, duration_t{-1}};
+    auto prev_it = utc_time_traffic_days.end();
+    for (auto day = tt_interval.from_; day != tt_interval.to_;
+         day += date::days{1}) {
+      auto const service_days = interval{day + first_day_offset,
+                                         day + last_day_offset + date::days{1}};
+      if (!selection.overlaps(service_days)) {
+        continue;
+      }
 
-    auto const gtfs_local_day_idx =
-        static_cast<std::size_t>((day - tt_interval.from_).count());
-    if (!fet.traffic_days_->test(gtfs_local_day_idx)) {
-      continue;
-    }
+      auto const gtfs_local_day_idx =
+          static_cast<std::size_t>((day - tt_interval.from_).count());
+      if (!fet.traffic_days_->test(gtfs_local_day_idx)) {
+        continue;
+      }
+
+      auto const tz_offset =
+          noon_offsets.at(tz).value().at(gtfs_local_day_idx);
+      auto const first_dep_utc = first_dep_time - tz_offset;
+      auto const first_dep_day_offset = date::days{static_cast<date::days::rep>(
+          std::floor(static_cast<double>(first_dep_utc.count()) / 1440))};
+      auto const utc_traffic_day =
+          (day - tt_interval.from_ + first_dep_day_offset).count();
 
-    auto const& first_trp = trip_data.get(fet.trips_.front());
-    auto const tz_offset =
-        noon_offsets.at(tt.providers_[first_trp.route_->agency_].tz_)
-            .value()
-            .at(gtfs_local_day_idx);
-    auto const first_dep_utc = first_dep_time - tz_offset;
-    auto const first_dep_day_offset = date::days{static_cast<date::days::rep>(
-        std::floor(static_cast<double>(first_dep_utc.count()) / 1440))};
-    auto const utc_traffic_day =
-        (day - tt_interval.from_ + first_dep_day_offset).count();
-
-    if (utc_traffic_day < 0 || utc_traffic_day >= kMaxDays) {
-      continue;
+      if (utc_traffic_day < 0 || utc_traffic_day >= kMaxDays) {
+        continue;
+      }
+
+      auto const key = conversion_key{first_dep_day_offset, tz_offset};
+      if (key == prev_key) {
+        prev_it->second.set(static_cast<std::size_t>(utc_traffic_day));
+      } else {
+        (prev_it = utc_time_traffic_days.emplace(key, bitfield{}).first)
+            ->second.set(static_cast<std::size_t>(utc_traffic_day));
+        prev_key = key;
+      }
     }
 
-    auto const key = conversion_key{first_dep_day_offset, tz_offset};
-    if (key == prev_key) {
-      prev_it->second.set(static_cast<std::size_t>(utc_traffic_day));
-    } else {
-      (prev_it = utc_time_traffic_days.emplace(key, bitfield{}).first)
-          ->second.set(static_cast<std::size_t>(utc_traffic_day));
-      prev_key = key;
+    auto partitions = utc_partitions_t{};
+    partitions.reserve(utc_time_traffic_days.size());
+    for (auto const& [key, traffic_days] : utc_time_traffic_days) {
+      partitions.emplace_back(key, traffic_days);
     }
-  }
+    return partitions;
+  };
+
+  auto const& partitions = utl::get_or_create(
+      cache,
+      utc_conversion_signature{.tz_ = tz,
+                               .first_dep_time_ = first_dep_time,
+                               .last_arr_time_ = last_arr_time,
+                               .traffic_days_ = *fet.traffic_days_},
+      compute_partitions);
 
   auto const build_time_string = [&](conversion_key const key) {
     std::basic_string<minutes_after_midnight_t> utc_time_mem;
@@ -223,7 +255,7 @@ void expand_local_to_utc(trip_data const& trip_data,
     return utc_time_mem;
   };
 
-  for (auto& [key, traffic_days] : utc_time_traffic_days) {
+  for (auto const& [key, traffic_days] : partitions) {
     consumer(utc_trip{
         .first_dep_offset_ =
             std::chrono::duration_cast<duration_t>(key.first_dep_day_offset_) +
@@ -334,11 +366,12 @@ void expand_trip(trip_data& trip_data,
                  bitfield const* traffic_days,
                  interval<date::sys_days> const& selection,
                  assistance_times* assist,
+                 local_to_utc_cache& utc_cache,
                  Consumer&& consumer) {
   expand_frequencies(
       trip_data, trips, traffic_days, [&](frequency_expanded_trip&& fet) {
         expand_local_to_utc(
-            trip_data, noon_offsets, tt, std::move(fet), selection,
+            trip_data, noon_offsets, tt, std::move(fet), selection, utc_cache,
             [&](utc_trip&& ut) {
               auto const c = trip_data.get(ut.trips_.front()).route_->clasz_;
               if (assist != nullptr &&
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "geo/box.h"
+#include "geo/latlng.h"
+
+namespace nigiri::loader::gtfs {
+
+// Bounding boxes over blocks of consecutive shape segments. Allows to skip
+// blocks that cannot contain a point closer than the best one found so far.
+struct shape_segment_index {
+  // Number of shape segments summarized by one bounding box.
+  static constexpr auto const kBlockSize = std::size_t{64U};
+
+  explicit shape_segment_index(std::span<geo::latlng const>);
+
+  // Lower bound for the great circle distance between pos and any point in
+  // the box. Boxes spanning 180 degrees of longitude or more are treated as
+  // covering all longitudes (shapes crossing the antimeridian).
+  static double min_distance(geo::latlng const& pos, geo::box const&);
+
+  // Same result as searching the shape points [from, to[ linearly:
+  // returns the index of the closest point of the closest segment.
+  std::size_t get_closest(geo::latlng const& pos,
+                          std::size_t from,
+                          std::size_t to) const;
+
+  std::span<geo::latlng const> shape_;
+
+  // Boxes contain the segment end points and the great circle arcs
+  // between them (which can reach beyond the latitude of their end points).
+  std::vector<geo::box> block_bboxes_;
+};
+
+}  // namespace nigiri::loader::gtfs
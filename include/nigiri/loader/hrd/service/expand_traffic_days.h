@@ -10,7 +10,7 @@ namespace nigiri::loader::hrd {
 template <typename Fn>
 void expand_traffic_days(service_store const& store,
                          service_idx_t const s_idx,
-                         stamm& st,
+                         stamm const& st,
                          Fn&& consumer) {
   auto const& s = store.get(s_idx);
 
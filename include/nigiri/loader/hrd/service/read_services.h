@@ -1,5 +1,10 @@
 #pragma once
 
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utl/parallel_for.h"
 #include "utl/parser/cstr.h"
 
 #include "nigiri/loader/hrd/service/expand_local_to_utc.h"
@@ -13,6 +18,12 @@
 
 namespace nigiri::loader::hrd {
 
+// Services are parsed sequentially (parsing registers providers, directions,
+// etc. in the timetable and has to be deterministic). The expensive part -
+// traffic day splitting, repetitions and local time to UTC conversion - runs
+// in parallel for batches of services. Results are passed to the consumer in
+// file order to keep the output deterministic. With parallel=false, the
+// expansion runs on the calling thread (same output).
 template <typename ConsumerFn>
 void parse_services(config const& c,
                     char const* filename,
@@ -23,13 +34,55 @@ void parse_services(config const& c,
                     stamm& st,
                     std::string_view file_content,
                     progress_update_fn const& progress_update,
-                    ConsumerFn&& consumer) {
-  auto const expand_service = [&](service_idx_t const s_idx) {
-    expand_traffic_days(store, s_idx, st, [&](ref_service const& a) {
-      expand_repetitions(store, a, [&](ref_service const& b) {
-        to_utc(store, st, hrd_interval, selection, b, consumer);
+                    ConsumerFn&& consumer,
+                    bool const parallel = true) {
+  constexpr auto const kBatchSize = 8192U;
+
+  struct expanded_service {
+    service_idx_t s_idx_;
+    unsigned line_number_;
+    std::vector<ref_service> ref_services_;
+    std::optional<std::string> error_;
+  };
+
+  auto batch = std::vector<expanded_service>{};
+  batch.reserve(kBatchSize);
+
+  auto const expand = [&](expanded_service& e) {
+    try {
+      expand_traffic_days(store, e.s_idx_, st, [&](ref_service const& a) {
+        expand_repetitions(store, a, [&](ref_service const& b) {
+          to_utc(store, st, hrd_interval, selection, b, [&](ref_service&& x) {
+            e.ref_services_.emplace_back(std::move(x));
+          });
+        });
       });
-    });
+    } catch (std::exception const& ex) {
+      e.error_ = ex.what();
+    }
+  };
+
+  auto const flush = [&]() {
+    if (parallel) {
+      utl::parallel_for_run(batch.size(),
+                            [&](std::size_t const i) { expand(batch[i]); });
+    } else {
+      for (auto& e : batch) {
+        expand(e);
+      }
+    }
+
+    for (auto& e : batch) {
+      for (auto& s : e.ref_services_) {
+        consumer(std::move(s));
+      }
+      if (e.error_.has_value()) {
+        log(log_lvl::error, "loader.hrd.service.expand",
+            "unable to build service at {}:{}: {}", filename, e.line_number_,
+            *e.error_);
+      }
+    }
+    batch.clear();
   };
 
   specification spec;
@@ -60,12 +113,19 @@ void parse_services(config const& c,
     } else if (!spec.ignore()) {
       // Store if relevant.
       try {
-        expand_service(store.add(service{c, st, source_file_idx, spec}));
+        batch.push_back(expanded_service{
+            .s_idx_ = store.add(service{c, st, source_file_idx, spec}),
+            .line_number_ = line_number,
+            .ref_services_ = {},
+            .error_ = std::nullopt});
       } catch (std::exception const& e) {
         log(log_lvl::error, "loader.hrd.service.expand",
             "unable to build service at {}:{}: {}", filename, line_number,
             e.what());
       }
+      if (batch.size() == kBatchSize) {
+        flush();
+      }
     }
 
     // Next try! Re-read first line of next service.
@@ -75,8 +135,13 @@ void parse_services(config const& c,
 
   if (!spec.is_empty() && spec.valid() && !spec.ignore()) {
     spec.line_number_to_ = last_line;
-    expand_service(store.add(service{c, st, source_file_idx, spec}));
+    batch.push_back(expanded_service{
+        .s_idx_ = store.add(service{c, st, source_file_idx, spec}),
+        .line_number_ = last_line,
+        .ref_services_ = {},
+        .error_ = std::nullopt});
   }
+  flush();
 }
 
 }  // namespace nigiri::loader::hrd
@@ -7,12 +7,13 @@
 
 namespace nigiri {
 struct timetable;
-}
+struct shapes_storage;
+}  // namespace nigiri
 
 namespace nigiri::loader {
 
 void register_special_stations(timetable&);
-void finalize(timetable&, finalize_options);
+void finalize(timetable&, finalize_options, shapes_storage* = nullptr);
 void finalize(timetable&,
               bool adjust_footpaths = false,
               bool merge_dupes_intra_src = false,
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+struct timetable;
+struct shapes_storage;
+}  // namespace nigiri
+
+namespace nigiri::loader {
+
+// Renumbers routes along a Hilbert curve over the center of their stops.
+// Routes serving the same area get close indices, so the route-indexed
+// arrays touched by a search (route marks, transport ranges, stop time
+// ranges, location sequences, route_stop_times_) are mostly contiguous.
+// All route-indexed timetable data (and the route bounding boxes of the
+// shapes storage, if given) is rewritten. Transport and location indices
+// do not change.
+void reorder_routes(timetable&, shapes_storage* = nullptr);
+
+// Renumbers locations along a Hilbert curve over their coordinates, so the
+// per-location arrays of a search (best times, station marks, lower bounds)
+// are mostly contiguous for the area of a query. Special stations keep their
+// indices. All location-indexed data and all references to locations are
+// rewritten, location_id_to_idx_ keeps mapping external ids to the new
+// indices. Returns the old -> new mapping for data kept outside of the
+// timetable.
+vector_map<location_idx_t, location_idx_t> reorder_locations(timetable&);
+
+}  // namespace nigiri::loader
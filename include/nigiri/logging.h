@@ -5,10 +5,13 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "fmt/core.h"
 #include "fmt/ostream.h"
 
+#include "nigiri/common/memory_usage.h"
+
 namespace nigiri {
 
 enum class log_lvl { debug, info, error };
@@ -67,6 +70,32 @@ struct scoped_timer final {
 
   std::string name_;
   std::chrono::time_point<std::chrono::steady_clock> start_;
+
+  // Memory usage is only read if the stage report was enabled when the
+  // timer was started (reading it parses /proc/self/status on Linux).
+  bool reported_{false};
+  memory_usage mem_start_;
+
+  // Peak RSS of this stage (only if the stage report is enabled and the
+  // platform supports resetting the peak RSS, see reset_peak_rss()).
+  std::size_t stage_peak_rss_{0U};
+  bool tracks_stage_peak_{false};
 };
 
+// Per-stage record of a finished scoped_timer.
+// Only collected after enable_stage_report() has been called.
+// peak_rss_ is the peak of this stage if stage_peak_ is set, otherwise it is
+// the peak of the whole process so far.
+struct stage_stats {
+  std::string name_;
+  double duration_ms_{0.0};
+  memory_usage begin_, end_;
+  std::size_t peak_rss_{0U};
+  bool stage_peak_{false};
+};
+
+void enable_stage_report();
+std::vector<stage_stats> get_stage_report();
+void write_stage_report(std::ostream&);
+
 }  // namespace nigiri
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+
+#include "nigiri/timetable.h"
+
+namespace nigiri {
+
+/*
+ * Read-only timetable mapped from a file written with timetable::write().
+ *
+ * The file is mapped copy-on-write (MAP_PRIVATE) and deserialized in place,
+ * without reading it into a heap buffer. Deserialization only writes the
+ * pages containing pointers (container headers). The bulk data (stop times,
+ * route sequences, footpaths, traffic days, ...) stays in clean page cache
+ * pages which are shared by all processes mapping the same file. Afterwards,
+ * the mapping is made read-only.
+ *
+ * Time zones are resolved while mapping. The timetable can not be modified
+ * (cold data of a hot file is accessed through lazy_cold_data).
+ *
+ * timetable_read_options::huge_pages_ is ignored (file backed memory),
+ * date_window_ is not supported (the timetable can not be modified).
+ * Platforms without mmap fall back to timetable::read().
+ */
+struct mapped_timetable {
+  explicit mapped_timetable(std::filesystem::path const&,
+                            timetable_read_options const& = {});
+  ~mapped_timetable();
+
+  mapped_timetable(mapped_timetable const&) = delete;
+  mapped_timetable& operator=(mapped_timetable const&) = delete;
+
+  mapped_timetable(mapped_timetable&&) noexcept;
+  mapped_timetable& operator=(mapped_timetable&&) noexcept;
+
+  timetable const& operator*() const { return *tt_; }
+  timetable const* operator->() const { return tt_; }
+  timetable const* get() const { return tt_; }
+
+private:
+  void reset();
+
+  void* addr_{nullptr};
+  std::size_t size_{0U};
+  timetable* tt_{nullptr};
+  std::optional<cista::wrapped<timetable>> fallback_;
+};
+
+}  // namespace nigiri
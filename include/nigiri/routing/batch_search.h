@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include "nigiri/routing/raptor/raptor.h"
+#include "nigiri/routing/search.h"
+
+namespace nigiri::routing {
+
+struct batch_result {
+  pareto_set<journey> journeys_;
+  interval<unixtime_t> interval_;
+  search_stats search_stats_;
+  raptor_stats algo_stats_;
+};
+
+// Runs all queries (same search direction) on a worker pool with one
+// search_state and raptor_state per worker thread. Queries with the same
+// destination (destination_, dest_match_mode_, td_dest_, via_stops_ and
+// max_travel_time_) share the destination preprocessing: destination sets
+// and lower bounds are computed only once per destination.
+// Results are returned in the order of the queries.
+std::vector<batch_result> raptor_batch_search(timetable const&,
+                                              rt_timetable const*,
+                                              std::vector<query>,
+                                              direction);
+
+}  // namespace nigiri::routing
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "nigiri/routing/query.h"
+#include "nigiri/types.h"
+
+namespace nigiri {
+struct timetable;
+}
+
+namespace nigiri::routing {
+
+// Bounded, thread-safe LRU cache of travel time lower bounds
+// (search_state::travel_time_lower_bound_) for popular destinations.
+// Entries are keyed by the normalized destination offsets, the destination
+// match mode, time dependent destination offsets, max. travel time, profile
+// and search direction. Using the cache with another timetable (see
+// timetable::id_) drops all entries. Call clear() if a timetable is
+// modified in place without timetable::renew_id().
+struct lower_bound_cache {
+  using lower_bounds_t = std::shared_ptr<std::vector<std::uint16_t> const>;
+
+  struct key {
+    friend bool operator==(key const&, key const&) = default;
+
+    direction search_dir_;
+    location_match_mode dest_match_mode_;
+    profile_idx_t prf_idx_;
+    duration_t max_travel_time_;
+    std::vector<offset> destination_;
+    std::vector<std::pair<location_idx_t, std::vector<td_offset>>> td_dest_;
+  };
+
+  struct key_hash {
+    std::size_t operator()(key const&) const;
+  };
+
+  explicit lower_bound_cache(std::size_t max_size);
+
+  lower_bounds_t get_or_compute(timetable const&, query const&, direction);
+  void clear();
+
+  std::size_t size() const;
+
+private:
+  using entry_t = std::pair<key, lower_bounds_t>;
+
+  std::size_t max_size_;
+  mutable std::mutex mutex_;
+  std::uint64_t tt_id_{0U};
+  std::list<entry_t> entries_;  // front = most recently used
+  hash_map<key, std::list<entry_t>::iterator, key_hash, std::equal_to<key>>
+      index_;
+};
+
+}  // namespace nigiri::routing
@@ -1,11 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cinttypes>
+#include <concepts>
+#include <iterator>
+#include <numeric>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace nigiri {
 
+// Elements providing transfers_ and dest_time_ are kept ordered by
+// (transfers_, dest_time_). This requires that an element can only be
+// dominated by elements with less or equal transfers (true for journeys):
+// dominance checks are then limited to the matching part of the set.
+// The order is internal: sort() orders the elements for output (as added,
+// or by a given criterion). Bookkeeping cost: the insertion order is kept
+// in a second vector (one more insert per add()), sort() additionally
+// sorts an index and permutes both vectors.
+template <typename T>
+concept pareto_ordered_by_transfers = requires(T const& a, T const& b) {
+  { a.transfers_ < b.transfers_ } -> std::convertible_to<bool>;
+  { a.dest_time_ < b.dest_time_ } -> std::convertible_to<bool>;
+};
+
 template <typename T>
 struct pareto_set {
   using iterator = typename std::vector<T>::iterator;
@@ -14,39 +34,242 @@ struct pareto_set {
   size_t size() const { return els_.size(); }
 
   std::tuple<bool, iterator, iterator> add(T&& el) {
-    auto n_removed = std::size_t{0};
-    for (auto i = 0U; i < els_.size(); ++i) {
-      if (els_[i].dominates(el)) {
-        return {false, end(), std::next(begin(), i)};
-      }
-      if (el.dominates(els_[i])) {
-        n_removed++;
+    if constexpr (pareto_ordered_by_transfers<T>) {
+      return add_ordered(std::move(el));
+    } else {
+      return add_unordered(std::move(el));
+    }
+  }
+
+  // Adds the elements of o in the order they were added to o.
+  void merge(pareto_set&& o) {
+    o.sort();
+    for (auto& el : o.els_) {
+      add(std::move(el));
+    }
+    o.clear();
+  }
+
+  // Orders the elements by cmp for output. Equal elements keep the order in
+  // which they were added. The next add() restores the internal order.
+  template <typename Cmp>
+  void sort(Cmp&& cmp) {
+    if constexpr (pareto_ordered_by_transfers<T>) {
+      sync_seq();
+      auto order = std::vector<std::size_t>(els_.size());
+      std::iota(order.begin(), order.end(), std::size_t{0U});
+      std::sort(order.begin(), order.end(),
+                [&](std::size_t const a, std::size_t const b) {
+                  return seq_[a] < seq_[b];
+                });
+      std::stable_sort(order.begin(), order.end(),
+                       [&](std::size_t const a, std::size_t const b) {
+                         return cmp(els_[a], els_[b]);
+                       });
+      permute(order);
+      ordered_ = false;
+    } else {
+      std::stable_sort(els_.begin(), els_.end(), cmp);
+    }
+  }
+
+  // Orders the elements as they were added.
+  void sort() { sort([](T const&, T const&) { return false; }); }
+
+  template <typename Pred>
+  void erase_if(Pred&& pred) {
+    sync_seq();
+    auto out = std::size_t{0U};
+    for (auto i = std::size_t{0U}; i != els_.size(); ++i) {
+      if (pred(std::as_const(els_[i]))) {
         continue;
       }
-      els_[i - n_removed] = els_[i];
+      if (out != i) {
+        els_[out] = std::move(els_[i]);
+        if constexpr (pareto_ordered_by_transfers<T>) {
+          seq_[out] = seq_[i];
+        }
+      }
+      ++out;
+    }
+    truncate(out);
+  }
+
+  // Mutable access for members that do not take part in the dominance
+  // check (e.g. the legs of a journey). fn must not change transfers_ and
+  // dest_time_ of ordered elements.
+  template <typename Fn>
+  void for_each_mutable(Fn&& fn) {
+    for (auto& el : els_) {
+      fn(el);
+    }
+    if constexpr (pareto_ordered_by_transfers<T>) {
+      assert(!ordered_ ||
+             std::is_sorted(els_.begin(), els_.end(), &is_ordered_before));
     }
-    els_.resize(els_.size() - n_removed + 1);
-    els_.back() = std::move(el);
-    return {true, std::next(begin(), static_cast<unsigned>(els_.size() - 1)),
-            end()};
   }
 
   friend const_iterator begin(pareto_set const& s) { return s.begin(); }
   friend const_iterator end(pareto_set const& s) { return s.end(); }
-  friend iterator begin(pareto_set& s) { return s.begin(); }
-  friend iterator end(pareto_set& s) { return s.end(); }
-  iterator begin() { return els_.begin(); }
-  iterator end() { return els_.end(); }
   const_iterator begin() const { return els_.begin(); }
   const_iterator end() const { return els_.end(); }
-  iterator erase(iterator const& it) { return els_.erase(it); }
+
+  // Mutable access (e.g. utl::sort() or utl::erase_if() on search results):
+  // the order of the elements at the next call of another member is taken
+  // as their insertion order, the next add() restores the internal order.
+  // Use std::as_const() for read-only iteration of a non-const set.
+  friend iterator begin(pareto_set& s) { return s.begin(); }
+  friend iterator end(pareto_set& s) { return s.end(); }
+  iterator begin() {
+    touch();
+    return els_.begin();
+  }
+  iterator end() {
+    touch();
+    return els_.end();
+  }
+  iterator erase(iterator const& it) {
+    touch();
+    return els_.erase(it);
+  }
   iterator erase(iterator const& from, iterator const& to) {
+    touch();
     return els_.erase(from, to);
   }
-  void clear() { els_.clear(); }
+
+  void clear() {
+    els_.clear();
+    seq_.clear();
+    next_seq_ = 0U;
+    ordered_ = true;
+    seq_stale_ = false;
+  }
 
 private:
+  void touch() {
+    if constexpr (pareto_ordered_by_transfers<T>) {
+      ordered_ = false;
+      seq_stale_ = true;
+    }
+  }
+
+  void sync_seq() {
+    if constexpr (pareto_ordered_by_transfers<T>) {
+      if (seq_stale_) {
+        seq_.resize(els_.size());
+        for (auto& seq : seq_) {
+          seq = next_seq_++;
+        }
+        seq_stale_ = false;
+      }
+    }
+  }
+
+  static bool is_ordered_before(T const& a, T const& b) {
+    return a.transfers_ < b.transfers_ ||
+           (a.transfers_ == b.transfers_ && a.dest_time_ < b.dest_time_);
+  }
+
+  void permute(std::vector<std::size_t> const& order) {
+    auto els = std::vector<T>{};
+    auto seq = std::vector<std::uint64_t>{};
+    els.reserve(order.size());
+    seq.reserve(order.size());
+    for (auto const i : order) {
+      els.emplace_back(std::move(els_[i]));
+      seq.emplace_back(seq_[i]);
+    }
+    els_ = std::move(els);
+    seq_ = std::move(seq);
+  }
+
+  void truncate(std::size_t const n) {
+    els_.erase(std::next(els_.begin(), static_cast<std::ptrdiff_t>(n)),
+               els_.end());
+    if constexpr (pareto_ordered_by_transfers<T>) {
+      seq_.resize(n);
+    }
+  }
+
+  std::tuple<bool, iterator, iterator> add_ordered(T&& el) {
+    sync_seq();
+    if (!ordered_) {
+      auto order = std::vector<std::size_t>(els_.size());
+      std::iota(order.begin(), order.end(), std::size_t{0U});
+      std::sort(order.begin(), order.end(),
+                [&](std::size_t const a, std::size_t const b) {
+                  return is_ordered_before(els_[a], els_[b]);
+                });
+      permute(order);
+      ordered_ = true;
+    }
+    assert(std::is_sorted(els_.begin(), els_.end(), &is_ordered_before));
+
+    // Only elements with <= transfers can dominate el.
+    auto const more_transfers = std::upper_bound(
+        els_.begin(), els_.end(), el, [](T const& a, T const& b) {
+          return a.transfers_ < b.transfers_;
+        });
+    for (auto it = els_.begin(); it != more_transfers; ++it) {
+      if (it->dominates(el)) {
+        return {false, els_.end(), it};
+      }
+    }
+
+    // Only elements with >= transfers can be dominated by el.
+    auto const same_transfers =
+        std::lower_bound(els_.begin(), more_transfers, el,
+                         [](T const& a, T const& b) {
+                           return a.transfers_ < b.transfers_;
+                         });
+    auto out = static_cast<std::size_t>(same_transfers - els_.begin());
+    for (auto i = out; i != els_.size(); ++i) {
+      if (el.dominates(els_[i])) {
+        continue;
+      }
+      if (out != i) {
+        els_[out] = std::move(els_[i]);
+        seq_[out] = seq_[i];
+      }
+      ++out;
+    }
+    truncate(out);
+
+    auto const pos = std::upper_bound(els_.begin(), els_.end(), el,
+                                      &is_ordered_before);
+    seq_.insert(std::next(seq_.begin(), pos - els_.begin()), next_seq_++);
+    return {true, els_.insert(pos, std::move(el)), els_.end()};
+  }
+
+  std::tuple<bool, iterator, iterator> add_unordered(T&& el) {
+    auto n_removed = std::size_t{0};
+    for (auto i = 0U; i < els_.size(); ++i) {
+      if (els_[i].dominates(el)) {
+        return {false, els_.end(), std::next(els_.begin(), i)};
+      }
+      if (el.dominates(els_[i])) {
+        n_removed++;
+        continue;
+      }
+      if (n_removed != 0U) {
+        els_[i - n_removed] = std::move(els_[i]);
+      }
+    }
+    els_.resize(els_.size() - n_removed + 1);
+    els_.back() = std::move(el);
+    return {true,
+            std::next(els_.begin(), static_cast<unsigned>(els_.size() - 1)),
+            els_.end()};
+  }
+
   std::vector<T> els_;
+
+  // Insertion sequence number per element (ordered elements only): keeps
+  // the output order independent of the internal order.
+  std::vector<std::uint64_t> seq_;
+  std::uint64_t next_seq_{0U};
+  bool ordered_{true};
+  bool seq_stale_{false};  // elements were accessed through iterator
 };
 
 }  // namespace nigiri
@@ -89,6 +89,10 @@ struct query {
   transfer_time_settings transfer_time_settings_{};
   std::vector<via_stop> via_stops_{};
   std::optional<duration_t> fastest_direct_{};
+
+  // RAPTOR only: record predecessors for faster journey reconstruction
+  // (sets raptor_state::record_predecessors_ of all used raptor states).
+  bool record_predecessors_{false};
 };
 
 }  // namespace nigiri::routing
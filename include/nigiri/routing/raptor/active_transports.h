@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "nigiri/timetable.h"
+#include "nigiri/types.h"
+
+namespace nigiri::routing {
+
+// Lazily computed index of transports active on a given day.
+// For each cached day, the bits of a route's transports are computed
+// together on first access. The transports of a route are contiguous, so the
+// bits of one route are contiguous as well (parallel to
+// timetable::route_transport_ranges_). This replaces the random read of
+// timetable::bitfields_[transport_traffic_days_[t]] for each candidate.
+// first_active() / last_active() find the next active transport of a route
+// with word operations on this bitmap. Only valid for the static timetable
+// (real-time updates are not reflected). The cache is keyed on timetable::id_.
+struct active_transports {
+  static constexpr auto const kMaxCachedDays = 16U;
+
+  struct day_entry {
+    std::size_t day_;
+    std::uint64_t last_use_;
+    bitvec route_ready_;
+    bitvec active_;
+  };
+
+  bool is_active(timetable const& tt,
+                 route_idx_t const r,
+                 transport_idx_t const t,
+                 std::size_t const day) {
+    return get_route(tt, r, day).active_.test(to_idx(t));
+  }
+
+  // First transport in [from, to[ of route r active on the given day.
+  // Returns `to` if there is none.
+  transport_idx_t first_active(timetable const&,
+                               route_idx_t r,
+                               transport_idx_t from,
+                               transport_idx_t to,
+                               std::size_t day);
+
+  // Last transport in [from, to[ of route r active on the given day.
+  // Returns transport_idx_t::invalid() if there is none.
+  transport_idx_t last_active(timetable const&,
+                              route_idx_t r,
+                              transport_idx_t from,
+                              transport_idx_t to,
+                              std::size_t day);
+
+  day_entry& get_route(timetable const& tt,
+                       route_idx_t const r,
+                       std::size_t const day) {
+    auto& d = get_day(tt, day);
+    if (!d.route_ready_.test(to_idx(r))) {
+      build_route(tt, d, r);
+    }
+    return d;
+  }
+
+  day_entry& get_day(timetable const& tt, std::size_t const day) {
+    if (tt_id_ == tt.id_ && last_ < days_.size() && days_[last_].day_ == day) {
+      return days_[last_];
+    }
+    return find_or_add_day(tt, day);
+  }
+
+  day_entry& find_or_add_day(timetable const&, std::size_t day);
+  void build_route(timetable const&, day_entry&, route_idx_t);
+  void clear();
+
+  std::uint64_t tt_id_{0U};
+  std::vector<day_entry> days_;
+  std::size_t last_{0U};
+  std::uint64_t use_count_{0U};
+};
+
+}  // namespace nigiri::routing
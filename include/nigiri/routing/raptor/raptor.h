@@ -3,7 +3,7 @@
 #include <cassert>
 
 #include "nigiri/common/delta_t.h"
-#include "nigiri/common/linear_lower_bound.h"
+#include "nigiri/common/event_time_search.h"
 #include "nigiri/routing/journey.h"
 #include "nigiri/routing/limits.h"
 #include "nigiri/routing/pareto_set.h"
@@ -33,9 +33,27 @@ struct raptor_stats {
          fp_update_prevented_by_lower_bound_},
         {"route_update_prevented_by_lower_bound",
          route_update_prevented_by_lower_bound_},
+        {"n_reconstruct_recorded_hits", n_reconstruct_recorded_hits_},
     };
   }
 
+  raptor_stats& operator+=(raptor_stats const& o) {
+    n_routing_time_ += o.n_routing_time_;
+    n_footpaths_visited_ += o.n_footpaths_visited_;
+    n_routes_visited_ += o.n_routes_visited_;
+    n_earliest_trip_calls_ += o.n_earliest_trip_calls_;
+    n_earliest_arrival_updated_by_route_ +=
+        o.n_earliest_arrival_updated_by_route_;
+    n_earliest_arrival_updated_by_footpath_ +=
+        o.n_earliest_arrival_updated_by_footpath_;
+    fp_update_prevented_by_lower_bound_ +=
+        o.fp_update_prevented_by_lower_bound_;
+    route_update_prevented_by_lower_bound_ +=
+        o.route_update_prevented_by_lower_bound_;
+    n_reconstruct_recorded_hits_ += o.n_reconstruct_recorded_hits_;
+    return *this;
+  }
+
   std::uint64_t n_routing_time_{0ULL};
   std::uint64_t n_footpaths_visited_{0ULL};
   std::uint64_t n_routes_visited_{0ULL};
@@ -44,6 +62,7 @@ struct raptor_stats {
   std::uint64_t n_earliest_arrival_updated_by_footpath_{0ULL};
   std::uint64_t fp_update_prevented_by_lower_bound_{0ULL};
   std::uint64_t route_update_prevented_by_lower_bound_{0ULL};
+  std::uint64_t n_reconstruct_recorded_hits_{0ULL};
 };
 
 template <direction SearchDir, bool Rt, via_offset_t Vias>
@@ -99,6 +118,7 @@ struct raptor {
         tmp_{state_.get_tmp<Vias>()},
         best_{state_.get_best<Vias>()},
         round_times_{state.get_round_times<Vias>()},
+        predecessors_{state.get_predecessors<Vias>()},
         is_dest_{is_dest},
         is_via_{is_via},
         dist_to_end_{dist_to_dest},
@@ -125,14 +145,30 @@ struct raptor {
 
   void reset_arrivals() {
     utl::fill(time_at_dest_, kInvalid);
-    round_times_.reset(kInvalidArray);
+    if (state_.is_reset_for(Vias + 1U, kInvalid) &&
+        state_.reset_touched_only()) {
+      for (auto const l : state_.touched_) {
+        for (auto k = 0U; k != kMaxTransfers + 1U; ++k) {
+          round_times_[k][l] = kInvalidArray;
+        }
+      }
+      reset_touched_locations();
+    } else {
+      round_times_.reset(kInvalidArray);
+      reset_all_locations();
+      state_.reset_stride_ = Vias + 1U;
+      state_.reset_invalid_ = kInvalid;
+    }
+    state_.clear_touched();
   }
 
   void next_start_time() {
-    utl::fill(best_, kInvalidArray);
-    utl::fill(tmp_, kInvalidArray);
-    utl::fill(state_.prev_station_mark_.blocks_, 0U);
-    utl::fill(state_.station_mark_.blocks_, 0U);
+    // Touched locations are kept: round_times_ is not reset.
+    if (state_.reset_touched_only()) {
+      reset_touched_locations();
+    } else {
+      reset_all_locations();
+    }
     utl::fill(state_.route_mark_.blocks_, 0U);
     if constexpr (Rt) {
       utl::fill(state_.rt_transport_mark_.blocks_, 0U);
@@ -142,6 +178,7 @@ struct raptor {
   void add_start(location_idx_t const l, unixtime_t const t) {
     auto const v = (Vias != 0 && is_via_[0][to_idx(l)]) ? 1U : 0U;
     trace_upd("adding start {}: {}, v={}\n", location{tt_, l}, t, v);
+    state_.touch(to_idx(l));
     best_[to_idx(l)][v] = unix_to_delta(base(), t);
     round_times_[0U][to_idx(l)][v] = unix_to_delta(base(), t);
     state_.station_mark_.set(to_idx(l), true);
@@ -161,11 +198,23 @@ struct raptor {
 
     trace_print_init_state();
 
+    state_.touch(kIntermodalTarget);
+
     for (auto k = 1U; k != end_k; ++k) {
-      for (auto i = 0U; i != n_locations_; ++i) {
+      // Only touched locations can have valid round times.
+      auto const update_best = [&](unsigned const i) {
         for (auto v = 0U; v != Vias + 1; ++v) {
           best_[i][v] = get_best(round_times_[k][i][v], best_[i][v]);
         }
+      };
+      if (state_.reset_touched_only()) {
+        for (auto const i : state_.touched_) {
+          update_best(i);
+        }
+      } else {
+        for (auto i = 0U; i != n_locations_; ++i) {
+          update_best(i);
+        }
       }
       is_dest_.for_each_set_bit([&](std::uint64_t const i) {
         update_time_at_dest(k, best_[i][Vias]);
@@ -173,6 +222,7 @@ struct raptor {
 
       auto any_marked = false;
       state_.station_mark_.for_each_set_bit([&](std::uint64_t const i) {
+        state_.touch(static_cast<unsigned>(i));
         for (auto const& r : tt_.location_routes_[location_idx_t{i}]) {
           any_marked = true;
           state_.route_mark_.set(to_idx(r), true);
@@ -227,6 +277,11 @@ struct raptor {
       trace_print_state_after_round();
     }
 
+    // Stations updated in the last round have not been consumed.
+    state_.station_mark_.for_each_set_bit([&](std::uint64_t const i) {
+      state_.touch(static_cast<unsigned>(i));
+    });
+
     is_dest_.for_each_set_bit([&](auto const i) {
       for (auto k = 1U; k != end_k; ++k) {
         auto const dest_time = round_times_[k][i][Vias];
@@ -251,7 +306,8 @@ struct raptor {
   }
 
   void reconstruct(query const& q, journey& j) {
-    reconstruct_journey<SearchDir>(tt_, rtt_, q, state_, j, base(), base_);
+    stats_.n_reconstruct_recorded_hits_ +=
+        reconstruct_journey<SearchDir>(tt_, rtt_, q, state_, j, base(), base_);
   }
 
 private:
@@ -259,6 +315,22 @@ private:
     return tt_.internal_interval_days().from_ + as_int(base_) * date::days{1};
   }
 
+  void reset_touched_locations() {
+    for (auto const l : state_.touched_) {
+      best_[l] = kInvalidArray;
+      tmp_[l] = kInvalidArray;
+      state_.station_mark_.set(l, false);
+      state_.prev_station_mark_.set(l, false);
+    }
+  }
+
+  void reset_all_locations() {
+    utl::fill(best_, kInvalidArray);
+    utl::fill(tmp_, kInvalidArray);
+    utl::fill(state_.prev_station_mark_.blocks_, 0U);
+    utl::fill(state_.station_mark_.blocks_, 0U);
+  }
+
   template <bool WithClaszFilter, bool WithBikeFilter>
   bool loop_routes(unsigned const k) {
     auto any_marked = false;
@@ -330,6 +402,8 @@ private:
 
   void update_transfers(unsigned const k) {
     state_.prev_station_mark_.for_each_set_bit([&](auto&& i) {
+      // Stations updated by loop_routes (tmp_).
+      state_.touch(static_cast<unsigned>(i));
       for (auto v = 0U; v != Vias + 1; ++v) {
         auto const tmp_time = tmp_[i][v];
         if (tmp_time == kInvalid) {
@@ -387,16 +461,12 @@ private:
   void update_footpaths(unsigned const k, profile_idx_t const prf_idx) {
     state_.prev_station_mark_.for_each_set_bit([&](std::uint64_t const i) {
       auto const l_idx = location_idx_t{i};
-      if constexpr (Rt) {
-        if (prf_idx != 0U && (kFwd ? rtt_->has_td_footpaths_out_
-                                   : rtt_->has_td_footpaths_in_)[prf_idx]
-                                 .test(l_idx)) {
-          return;
-        }
+      if (has_td_footpaths(prf_idx, l_idx)) {
+        return;
       }
 
-      auto const& fps = kFwd ? tt_.locations_.footpaths_out_[prf_idx][l_idx]
-                             : tt_.locations_.footpaths_in_[prf_idx][l_idx];
+      auto const fps = kFwd ? tt_.locations_.footpaths_out(prf_idx, l_idx)
+                            : tt_.locations_.footpaths_in(prf_idx, l_idx);
 
       for (auto const& fp : fps) {
         ++stats_.n_footpaths_visited_;
@@ -479,25 +549,63 @@ private:
     });
   }
 
-  void update_td_offsets(unsigned const k, profile_idx_t const prf_idx) {
-    if constexpr (!Rt) {
-      return;
+  static bool is_set(bitvec_map<location_idx_t> const& v,
+                     location_idx_t const l) {
+    return to_idx(l) < v.size() && v.test(l);
+  }
+
+  bool has_td_footpaths(profile_idx_t const prf_idx,
+                        location_idx_t const l) const {
+    if (prf_idx == 0U) {
+      return false;
+    }
+    if constexpr (Rt) {
+      if (is_set((kFwd ? rtt_->has_td_footpaths_out_
+                       : rtt_->has_td_footpaths_in_)[prf_idx],
+                 l)) {
+        return true;
+      }
     }
+    return is_set((kFwd ? tt_.locations_.has_td_footpaths_out_
+                        : tt_.locations_.has_td_footpaths_in_)[prf_idx],
+                  l);
+  }
+
+  // Real-time footpaths take precedence over the static timetable.
+  auto get_td_footpaths(profile_idx_t const prf_idx,
+                        location_idx_t const l) const {
+    if constexpr (Rt) {
+      if (is_set((kFwd ? rtt_->has_td_footpaths_out_
+                       : rtt_->has_td_footpaths_in_)[prf_idx],
+                 l)) {
+        return kFwd ? rtt_->td_footpaths_out_[prf_idx][l]
+                    : rtt_->td_footpaths_in_[prf_idx][l];
+      }
+    }
+    return kFwd ? tt_.locations_.td_footpaths_out_[prf_idx][l]
+                : tt_.locations_.td_footpaths_in_[prf_idx][l];
+  }
 
+  void update_td_offsets(unsigned const k, profile_idx_t const prf_idx) {
     if (prf_idx == 0U) {
       return;
     }
 
+    if constexpr (!Rt) {
+      if ((kFwd ? tt_.locations_.has_td_footpaths_out_
+                : tt_.locations_.has_td_footpaths_in_)[prf_idx]
+              .size() == 0U) {
+        return;
+      }
+    }
+
     state_.prev_station_mark_.for_each_set_bit([&](std::uint64_t const i) {
       auto const l_idx = location_idx_t{i};
-      if (!(kFwd ? rtt_->has_td_footpaths_out_
-                 : rtt_->has_td_footpaths_in_)[prf_idx]
-               .test(l_idx)) {
+      if (!has_td_footpaths(prf_idx, l_idx)) {
         return;
       }
 
-      auto const& fps = kFwd ? rtt_->td_footpaths_out_[prf_idx][l_idx]
-                             : rtt_->td_footpaths_in_[prf_idx][l_idx];
+      auto const fps = get_td_footpaths(prf_idx, l_idx);
 
       for (auto v = 0U; v != Vias + 1; ++v) {
         auto const tmp_time = tmp_[i][v];
@@ -879,6 +987,8 @@ private:
                 location{tt_, stp.location_idx()});
 
             ++stats_.n_earliest_arrival_updated_by_route_;
+            record_predecessor(k, l_idx, target_v, by_transport, et[v],
+                               stop_idx);
             tmp_[l_idx][target_v] =
                 get_best(by_transport, tmp_[l_idx][target_v]);
             state_.station_mark_.set(l_idx, true);
@@ -937,6 +1047,8 @@ private:
                   location{tt_, stp.location_idx()});
 
               ++stats_.n_earliest_arrival_updated_by_route_;
+              record_predecessor(k, l_idx, dest_v, by_transport, et[v],
+                                 stop_idx);
               tmp_[l_idx][dest_v] = get_best(by_transport, tmp_[l_idx][dest_v]);
               state_.station_mark_.set(l_idx, true);
               any_marked = true;
@@ -999,6 +1111,18 @@ private:
     return any_marked;
   }
 
+  void record_predecessor(unsigned const k,
+                          std::size_t const l_idx,
+                          std::size_t const v,
+                          delta_t const by_transport,
+                          transport const t,
+                          stop_idx_t const stop_idx) {
+    if (predecessors_.n_rows_ != 0U &&
+        is_better_or_eq(by_transport, tmp_[l_idx][v])) {
+      predecessors_[k][l_idx][v] = {t.t_idx_, t.day_, stop_idx};
+    }
+  }
+
   transport get_earliest_transport(unsigned const k,
                                    route_idx_t const r,
                                    stop_idx_t const stop_idx,
@@ -1007,15 +1131,30 @@ private:
                                    location_idx_t const l) {
     ++stats_.n_earliest_trip_calls_;
 
-    auto const event_times = tt_.event_times_at_stop(
-        r, stop_idx, kFwd ? event_type::kDep : event_type::kArr);
+    // Routes with frequency runs only need the first event of each run to
+    // find the first reachable event, so their events are read one by one
+    // instead of decoding the whole (possibly compressed) column.
+    auto const ev_type = kFwd ? event_type::kDep : event_type::kArr;
+    auto const transports = tt_.route_transport_ranges_[r];
+    auto const n_events = static_cast<std::size_t>(transports.size());
+    auto const has_runs = tt_.has_frequency_runs(r);
+    auto const event_times =
+        has_runs ? std::span<delta const>{}
+                 : tt_.event_times_at_stop(r, stop_idx, ev_type,
+                                           event_times_buf_);
+    auto const event_at = [&](std::size_t const t_offset) {
+      if (has_runs) {
+        return tt_.event_mam(r, transports[t_offset], stop_idx, ev_type);
+      }
+      return event_times[t_offset];
+    };
 
-    auto const seek_first_day = [&]() {
-      return linear_lb(get_begin_it(event_times), get_end_it(event_times),
-                       mam_at_stop,
-                       [&](delta const a, minutes_after_midnight_t const b) {
-                         return is_better(a.mam(), b.count());
-                       });
+    auto const n_unreachable = [&]() {
+      auto const key = static_cast<std::int16_t>(mam_at_stop.count());
+      return has_runs ? n_unreachable_events<SearchDir>(
+                            n_events, tt_.route_frequency_runs_[r], key,
+                            event_at)
+                      : n_unreachable_events<SearchDir>(event_times, key);
     };
 
 #if defined(NIGIRI_TRACING)
@@ -1029,18 +1168,13 @@ private:
 
     constexpr auto const kNDaysToIterate = day_idx_t::value_t{2U};
     for (auto i = day_idx_t::value_t{0U}; i != kNDaysToIterate; ++i) {
-      auto const ev_time_range =
-          it_range{i == 0U ? seek_first_day() : get_begin_it(event_times),
-                   get_end_it(event_times)};
-      if (ev_time_range.empty()) {
-        continue;
-      }
-
       auto const day = kFwd ? day_at_stop + i : day_at_stop - i;
-      for (auto it = begin(ev_time_range); it != end(ev_time_range); ++it) {
-        auto const t_offset =
-            static_cast<std::size_t>(&*it - event_times.data());
-        auto const ev = *it;
+
+      // pos counts events in search direction.
+      for (auto pos = i == 0U ? n_unreachable() : std::size_t{0U};
+           pos < n_events; ++pos) {
+        auto const t_offset = kFwd ? pos : n_events - pos - 1U;
+        auto const ev = event_at(t_offset);
         auto const ev_mam = ev.mam();
 
         if (is_better_or_eq(time_at_dest_[k],
@@ -1071,7 +1205,7 @@ private:
         auto const ev_day_offset = ev.days();
         auto const start_day =
             static_cast<std::size_t>(as_int(day) - ev_day_offset);
-        if (!is_transport_active(t, start_day)) {
+        if (!is_transport_active(r, t, start_day)) {
           trace(
               "┊ │k={}      => transport={}, name={}, dbg={}, day={}/{}, "
               "ev_day_offset={}, "
@@ -1079,6 +1213,9 @@ private:
               "transport_mam={}, transport_time={} => NO TRAFFIC!\n",
               k, t, tt_.transport_name(t), tt_.dbg(t), i, day, ev_day_offset,
               mam_at_stop, ev_mam, ev);
+          if constexpr (!Rt) {
+            pos += n_skippable_inactive(r, t_offset, start_day, event_at);
+          }
           continue;
         }
 
@@ -1093,12 +1230,52 @@ private:
     return {};
   }
 
-  bool is_transport_active(transport_idx_t const t,
-                           std::size_t const day) const {
+  // Number of transports following t_offset in search direction that are
+  // inactive on start_day and can be skipped without changing the result of
+  // get_earliest_transport(): the transport after them (the next active one)
+  // has the same day offset at this stop, so all of them share start_day and
+  // their event times are not better than the one of the next active one.
+  template <typename EventAt>
+  std::size_t n_skippable_inactive(route_idx_t const r,
+                                   std::size_t const t_offset,
+                                   std::size_t const start_day,
+                                   EventAt const& event_at) {
+    auto const transports = tt_.route_transport_ranges_[r];
+    auto const t = transport_idx_t{static_cast<transport_idx_t::value_t>(
+        to_idx(transports.from_) + t_offset)};
+    auto const day_offset = event_at(t_offset).days();
+    if constexpr (kFwd) {
+      auto const next = state_.active_transports_.first_active(
+          tt_, r, transport_idx_t{to_idx(t) + 1U}, transports.to_, start_day);
+      if (next == transports.to_) {
+        return 0U;
+      }
+      auto const next_offset =
+          static_cast<std::size_t>(to_idx(next) - to_idx(transports.from_));
+      return event_at(next_offset).days() == day_offset
+                 ? (next_offset - t_offset - 1U)
+                 : 0U;
+    } else {
+      auto const prev = state_.active_transports_.last_active(
+          tt_, r, transports.from_, t, start_day);
+      if (prev == transport_idx_t::invalid()) {
+        return 0U;
+      }
+      auto const prev_offset =
+          static_cast<std::size_t>(to_idx(prev) - to_idx(transports.from_));
+      return event_at(prev_offset).days() == day_offset
+                 ? (t_offset - prev_offset - 1U)
+                 : 0U;
+    }
+  }
+
+  bool is_transport_active(route_idx_t const r,
+                           transport_idx_t const t,
+                           std::size_t const day) {
     if constexpr (Rt) {
       return rtt_->bitfields_[rtt_->transport_traffic_days_[t]].test(day);
     } else {
-      return tt_.bitfields_[tt_.transport_traffic_days_[t]].test(day);
+      return state_.active_transports_.is_active(tt_, r, t, day);
     }
   }
 
@@ -1137,24 +1314,6 @@ private:
 
   int as_int(day_idx_t const d) const { return static_cast<int>(d.v_); }
 
-  template <typename T>
-  auto get_begin_it(T const& t) {
-    if constexpr (kFwd) {
-      return t.begin();
-    } else {
-      return t.rbegin();
-    }
-  }
-
-  template <typename T>
-  auto get_end_it(T const& t) {
-    if constexpr (kFwd) {
-      return t.end();
-    } else {
-      return t.rend();
-    }
-  }
-
   timetable const& tt_;
   rt_timetable const* rtt_{nullptr};
   int n_days_;
@@ -1163,6 +1322,7 @@ private:
   std::span<std::array<delta_t, Vias + 1>> tmp_;
   std::span<std::array<delta_t, Vias + 1>> best_;
   flat_matrix_view<std::array<delta_t, Vias + 1>> round_times_;
+  flat_matrix_view<std::array<raptor_predecessor, Vias + 1>> predecessors_;
   bitvec const& is_dest_;
   std::array<bitvec, kMaxVias> const& is_via_;
   std::vector<std::uint16_t> const& dist_to_end_;
@@ -1172,6 +1332,7 @@ private:
   std::array<delta_t, kMaxTransfers + 1> time_at_dest_;
   day_idx_t base_;
   raptor_stats stats_;
+  std::vector<delta> event_times_buf_;  // decoded compressed stop times
   clasz_mask_t allowed_claszes_;
   bool require_bike_transport_;
   bool is_wheelchair_;
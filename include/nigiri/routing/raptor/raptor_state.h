@@ -12,6 +12,8 @@
 #include "nigiri/common/delta_t.h"
 #include "nigiri/common/flat_matrix_view.h"
 #include "nigiri/routing/limits.h"
+#include "nigiri/routing/raptor/active_transports.h"
+#include "nigiri/types.h"
 
 namespace nigiri {
 struct timetable;
@@ -19,6 +21,17 @@ struct timetable;
 
 namespace nigiri::routing {
 
+// Static timetable transport that produced the arrival label tmp_[l][v] in
+// round k. stop_idx_ is the stop index of location l in the transport's
+// route (a route can visit a location more than once).
+struct raptor_predecessor {
+  bool is_valid() const { return t_idx_ != transport_idx_t::invalid(); }
+
+  transport_idx_t t_idx_{transport_idx_t::invalid()};
+  day_idx_t day_{day_idx_t::invalid()};
+  stop_idx_t stop_idx_{0U};
+};
+
 struct raptor_state {
   raptor_state() = default;
   raptor_state(raptor_state const&) = delete;
@@ -74,15 +87,81 @@ struct raptor_state {
             n_locations_};
   }
 
+  template <via_offset_t Vias>
+  flat_matrix_view<std::array<raptor_predecessor, Vias + 1>>
+  get_predecessors() {
+    return {{reinterpret_cast<std::array<raptor_predecessor, Vias + 1>*>(
+                 predecessors_storage_.data()),
+             predecessors_storage_.empty()
+                 ? 0U
+                 : n_locations_ * (kMaxTransfers + 1)},
+            predecessors_storage_.empty() ? 0U : kMaxTransfers + 1U,
+            n_locations_};
+  }
+
+  template <via_offset_t Vias>
+  flat_matrix_view<std::array<raptor_predecessor, Vias + 1> const>
+  get_predecessors() const {
+    return {{reinterpret_cast<std::array<raptor_predecessor, Vias + 1> const*>(
+                 predecessors_storage_.data()),
+             predecessors_storage_.empty()
+                 ? 0U
+                 : n_locations_ * (kMaxTransfers + 1)},
+            predecessors_storage_.empty() ? 0U : kMaxTransfers + 1U,
+            n_locations_};
+  }
+
+  bool has_predecessors() const { return !predecessors_storage_.empty(); }
+
+  // Locations that might hold a valid entry in tmp_, best_, round_times_
+  // or a set bit in station_mark_ / prev_station_mark_. All other entries
+  // hold reset_invalid_ (layout: reset_stride_ = Vias + 1 entries per
+  // location). This allows resetting only what the last search touched.
+  void touch(unsigned const l) {
+    if (!is_touched_.test(l)) {
+      is_touched_.set(l, true);
+      touched_.push_back(l);
+    }
+  }
+
+  bool is_reset_for(unsigned const stride, delta_t const invalid) const {
+    return reset_stride_ == stride && reset_invalid_ == invalid;
+  }
+
+  bool reset_touched_only() const {
+    return touched_.size() < n_locations_ / kMaxTouchedFraction;
+  }
+
+  void clear_touched();
+
+  // Above n_locations / kMaxTouchedFraction touched locations,
+  // a full reset of all entries is faster.
+  static constexpr auto const kMaxTouchedFraction = 8U;
+
+  // Record the transport producing each arrival label during the search.
+  // Speeds up journey reconstruction (direct lookup instead of scanning all
+  // routes and transports serving a stop) at the cost of
+  // n_locations * (kMaxVias + 1) * (kMaxTransfers + 1) * 8 bytes.
+  // Entries are not reset between searches: reconstruction validates them
+  // and falls back to scanning if they don't match.
+  // Also enabled by query::record_predecessors_ (see raptor_search()).
+  bool record_predecessors_{false};
+
   unsigned n_locations_{};
+  std::vector<unsigned> touched_;
+  bitvec is_touched_;
+  unsigned reset_stride_{0U};
+  delta_t reset_invalid_{0};
   std::vector<delta_t> tmp_storage_;
   std::vector<delta_t> best_storage_;
   std::vector<delta_t> round_times_storage_;
+  std::vector<raptor_predecessor> predecessors_storage_;
   bitvec station_mark_;
   bitvec prev_station_mark_;
   bitvec route_mark_;
   bitvec rt_transport_mark_;
   bitvec end_reachable_;
+  active_transports active_transports_;
 };
 
 }  // namespace nigiri::routing
@@ -14,14 +14,16 @@ struct search_state;
 struct raptor_state;
 struct journey;
 
+// Returns the number of transport legs found through the predecessors
+// recorded in raptor_state (see raptor_state::record_predecessors_).
 template <direction SearchDir>
-void reconstruct_journey(timetable const&,
-                         rt_timetable const*,
-                         query const&,
-                         raptor_state const&,
-                         journey&,
-                         date::sys_days const base,
-                         day_idx_t const base_day_idx);
+unsigned reconstruct_journey(timetable const&,
+                             rt_timetable const*,
+                             query const&,
+                             raptor_state const&,
+                             journey&,
+                             date::sys_days const base,
+                             day_idx_t const base_day_idx);
 
 template <direction SearchDir>
 void optimize_footpaths(timetable const&,
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <span>
+
 #include "nigiri/routing/raptor/raptor.h"
 #include "nigiri/routing/search.h"
 #include "nigiri/timetable.h"
@@ -13,6 +15,7 @@ routing_result<raptor_stats> raptor_search(
     raptor_state& r_state,
     query q,
     direction search_dir,
-    std::optional<std::chrono::seconds> timeout = std::nullopt);
+    std::optional<std::chrono::seconds> timeout = std::nullopt,
+    std::span<raptor_state> worker_states = {});
 
 }  // namespace nigiri::routing
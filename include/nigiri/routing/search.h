@@ -1,10 +1,14 @@
 #pragma once
 
+#include <span>
+#include <utility>
+
 #include "fmt/format.h"
 
 #include "utl/enumerate.h"
 #include "utl/equal_ranges_linear.h"
 #include "utl/erase_if.h"
+#include "utl/parallel_for.h"
 #include "utl/timing.h"
 #include "utl/to_vec.h"
 
@@ -16,6 +20,7 @@
 #include "nigiri/routing/interval_estimate.h"
 #include "nigiri/routing/journey.h"
 #include "nigiri/routing/limits.h"
+#include "nigiri/routing/lower_bound_cache.h"
 #include "nigiri/routing/pareto_set.h"
 #include "nigiri/routing/query.h"
 #include "nigiri/routing/start_times.h"
@@ -38,6 +43,14 @@ struct search_state {
   std::vector<std::uint16_t> dist_to_dest_;
   std::vector<start> starts_;
   pareto_set<journey> results_;
+
+  // Optional cache for travel_time_lower_bound_ (shared between searches).
+  lower_bound_cache* lb_cache_{nullptr};
+
+  // Set if is_destination_, is_via_, dist_to_dest_ and
+  // travel_time_lower_bound_ already match the next query (see
+  // prepare_destinations). The next search skips computing them once.
+  bool destinations_prepared_{false};
 };
 
 struct search_stats {
@@ -56,6 +69,41 @@ struct search_stats {
   std::chrono::milliseconds execute_time_{0LL};
 };
 
+// Destination dependent part of the search preprocessing. Only depends on
+// destination_, dest_match_mode_, td_dest_, via_stops_ and max_travel_time_
+// of the query. Returns the time spent computing lower bounds (ms).
+inline std::uint64_t prepare_destinations(timetable const& tt,
+                                          query const& q,
+                                          direction const search_dir,
+                                          bool const with_lower_bounds,
+                                          search_state& s) {
+  collect_destinations(tt, q.destination_, q.dest_match_mode_,
+                       s.is_destination_, s.dist_to_dest_);
+
+  for (auto const [i, via] : utl::enumerate(q.via_stops_)) {
+    collect_via_destinations(tt, via.location_, s.is_via_[i]);
+  }
+
+  if (!with_lower_bounds) {
+    return 0U;
+  }
+
+  auto lb_span = get_otel_tracer()->StartSpan("lower bounds");
+  auto lb_scope = opentelemetry::trace::Scope{lb_span};
+  UTL_START_TIMING(lb);
+  if (s.lb_cache_ != nullptr) {
+    auto const lb = s.lb_cache_->get_or_compute(tt, q, search_dir);
+    s.travel_time_lower_bound_.assign(begin(*lb), end(*lb));
+  } else {
+    dijkstra(tt, q,
+             search_dir == direction::kForward ? tt.fwd_search_lb_graph_
+                                               : tt.bwd_search_lb_graph_,
+             s.travel_time_lower_bound_);
+  }
+  UTL_STOP_TIMING(lb);
+  return static_cast<std::uint64_t>(UTL_TIMING_MS(lb));
+}
+
 template <typename AlgoStats>
 struct routing_result {
   pareto_set<journey> const* journeys_{nullptr};
@@ -71,10 +119,7 @@ struct search {
   static constexpr auto const kFwd = (SearchDir == direction::kForward);
   static constexpr auto const kBwd = (SearchDir == direction::kBackward);
 
-  Algo init(clasz_mask_t const allowed_claszes,
-            bool const require_bikes_allowed,
-            transfer_time_settings& tts,
-            algo_state_t& algo_state) {
+  Algo init(transfer_time_settings& tts, algo_state_t& algo_state) {
     auto span = get_otel_tracer()->StartSpan("search::init");
     auto scope = opentelemetry::trace::Scope{span};
 
@@ -92,22 +137,14 @@ struct search {
                    && tts.min_transfer_time_ == 0_minutes  //
                    && tts.additional_time_ == 0_minutes;
 
-    collect_destinations(tt_, q_.destination_, q_.dest_match_mode_,
-                         state_.is_destination_, state_.dist_to_dest_);
-
-    for (auto const [i, via] : utl::enumerate(q_.via_stops_)) {
-      collect_via_destinations(tt_, via.location_, state_.is_via_[i]);
+    if (state_.destinations_prepared_) {
+      state_.destinations_prepared_ = false;
+    } else {
+      stats_.lb_time_ = prepare_destinations(tt_, q_, SearchDir,
+                                             Algo::kUseLowerBounds, state_);
     }
 
     if constexpr (Algo::kUseLowerBounds) {
-      auto lb_span = get_otel_tracer()->StartSpan("lower bounds");
-      auto lb_scope = opentelemetry::trace::Scope{lb_span};
-      UTL_START_TIMING(lb);
-      dijkstra(tt_, q_,
-               kFwd ? tt_.fwd_search_lb_graph_ : tt_.bwd_search_lb_graph_,
-               state_.travel_time_lower_bound_);
-      UTL_STOP_TIMING(lb);
-      stats_.lb_time_ = static_cast<std::uint64_t>(UTL_TIMING_MS(lb));
 
 #if defined(NIGIRI_TRACING)
       for (auto const& o : q_.start_) {
@@ -125,6 +162,10 @@ struct search {
 #endif
     }
 
+    return make_algo(algo_state);
+  }
+
+  Algo make_algo(algo_state_t& algo_state) {
     return Algo{
         tt_,
         rtt_,
@@ -142,10 +183,10 @@ struct search {
                     ((search_interval_.to_ - search_interval_.from_) / 2)) -
                 tt_.internal_interval().from_)
                 .count()},
-        allowed_claszes,
-        require_bikes_allowed,
+        q_.allowed_claszes_,
+        q_.require_bike_transport_,
         q_.prf_idx_ == 2U,
-        tts};
+        q_.transfer_time_settings_};
   }
 
   search(timetable const& tt,
@@ -168,16 +209,22 @@ struct search {
                             }},
             q_.start_time_)},
         fastest_direct_{get_fastest_direct(tt_, q_, SearchDir)},
-        algo_{init(q_.allowed_claszes_,
-                   q_.require_bike_transport_,
-                   q_.transfer_time_settings_,
-                   algo_state)},
+        algo_{init(q_.transfer_time_settings_, algo_state)},
         timeout_(timeout) {
     utl::sort(q_.start_);
     utl::sort(q_.destination_);
     q.sanitize(tt);
   }
 
+  // Enables the parallel range mode for pre-trip queries: the start times of
+  // the search interval are split into one contiguous chunk per worker state.
+  // Each worker runs its own Algo instance (pruning only with its own
+  // results). The results are merged into one pareto set afterwards.
+  search& with_workers(std::span<algo_state_t> worker_states) {
+    worker_states_ = worker_states;
+    return *this;
+  }
+
   routing_result<algo_stats_t> execute() {
     auto span = get_otel_tracer()->StartSpan("search::execute");
     auto scope = opentelemetry::trace::Scope{span};
@@ -292,26 +339,32 @@ struct search {
     }
 
     if (is_pretrip()) {
-      utl::erase_if(state_.results_, [&](journey const& j) {
+      state_.results_.erase_if([&](journey const& j) {
         return !search_interval_.contains(j.start_time_) ||
                j.travel_time() >= fastest_direct_ ||
                j.travel_time() > q_.max_travel_time_;
       });
-      utl::sort(state_.results_, [](journey const& a, journey const& b) {
+      state_.results_.sort([](journey const& a, journey const& b) {
         return a.start_time_ < b.start_time_;
       });
+    } else {
+      state_.results_.sort();
     }
 
     stats_.execute_time_ =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             (std::chrono::steady_clock::now() - processing_start_time));
+    auto algo_stats = algo_.get_stats();
+    algo_stats += worker_stats_;
     return {.journeys_ = &state_.results_,
             .interval_ = search_interval_,
             .search_stats_ = stats_,
-            .algo_stats_ = algo_.get_stats()};
+            .algo_stats_ = algo_stats};
   }
 
 private:
+  using start_it_t = std::vector<start>::const_iterator;
+
   bool is_ontrip() const {
     return holds_alternative<unixtime_t>(q_.start_time_);
   }
@@ -346,9 +399,10 @@ private:
 
   unsigned n_results_in_interval() const {
     if (holds_alternative<interval<unixtime_t>>(q_.start_time_)) {
-      auto count = utl::count_if(state_.results_, [&](journey const& j) {
-        return search_interval_.contains(j.start_time_);
-      });
+      auto count =
+          utl::count_if(std::as_const(state_.results_), [&](journey const& j) {
+            return search_interval_.contains(j.start_time_);
+          });
       return static_cast<unsigned>(count);
     } else {
       return static_cast<unsigned>(state_.results_.size());
@@ -378,7 +432,7 @@ private:
   }
 
   void remove_ontrip_results() {
-    utl::erase_if(state_.results_, [&](journey const& j) {
+    state_.results_.erase_if([&](journey const& j) {
       return !search_interval_.contains(j.start_time_);
     });
   }
@@ -387,51 +441,88 @@ private:
     auto span = get_otel_tracer()->StartSpan("search::search_interval");
     auto scope = opentelemetry::trace::Scope{span};
 
+    auto start_time_ranges = std::vector<std::pair<start_it_t, start_it_t>>{};
     utl::equal_ranges_linear(
         state_.starts_,
         [](start const& a, start const& b) {
           return a.time_at_start_ == b.time_at_start_;
         },
         [&](auto&& from_it, auto&& to_it) {
-          algo_.next_start_time();
-          auto const start_time = from_it->time_at_start_;
-          for (auto const& s : it_range{from_it, to_it}) {
-            trace("init: time_at_start={}, time_at_stop={} at {}\n",
-                  s.time_at_start_, s.time_at_stop_, location_idx_t{s.stop_});
-            algo_.add_start(s.stop_, s.time_at_stop_);
-          }
-
-          /*
-           * Upper bound: Search journeys faster than 'worst_time_at_dest'
-           * It will not find journeys with the same duration
-           */
-          auto const worst_time_at_dest =
-              start_time + (kFwd ? 1 : -1) *
-                               (std::min(fastest_direct_, q_.max_travel_time_) +
-                                duration_t{1});
-          algo_.execute(start_time, q_.max_transfers_, worst_time_at_dest,
-                        q_.prf_idx_, state_.results_);
-
-          for (auto& j : state_.results_) {
-            if (j.legs_.empty() &&
-                (is_ontrip() || search_interval_.contains(j.start_time_)) &&
-                j.travel_time() < fastest_direct_) {
-              try {
-                algo_.reconstruct(q_, j);
-              } catch (std::exception const& e) {
-                j.error_ = true;
-                log(log_lvl::error, "search", "reconstruct failed: {}",
-                    e.what());
-                span->SetStatus(opentelemetry::trace::StatusCode::kError,
-                                "exception");
-                span->AddEvent(
-                    "exception",
-                    {{"exception.message",
-                      fmt::format("reconstruct failed: {}", e.what())}});
-              }
-            }
-          }
+          start_time_ranges.emplace_back(from_it, to_it);
         });
+
+    if (is_ontrip() || worker_states_.size() < 2U ||
+        start_time_ranges.size() < 2U) {
+      for (auto const& [from_it, to_it] : start_time_ranges) {
+        search_start_time(algo_, from_it, to_it, state_.results_, *span);
+      }
+      return;
+    }
+
+    // Contiguous chunks keep the rRAPTOR pruning within each worker.
+    auto const n_workers = std::min(worker_states_.size(),
+                                    start_time_ranges.size());
+    auto worker_results = std::vector<pareto_set<journey>>(n_workers);
+    auto worker_stats = std::vector<algo_stats_t>(n_workers);
+    utl::parallel_for_run(n_workers, [&](std::size_t const i) {
+      auto algo = make_algo(worker_states_[i]);
+      auto const from = i * start_time_ranges.size() / n_workers;
+      auto const to = (i + 1U) * start_time_ranges.size() / n_workers;
+      for (auto r = from; r != to; ++r) {
+        search_start_time(algo, start_time_ranges[r].first,
+                          start_time_ranges[r].second, worker_results[i],
+                          *span);
+      }
+      worker_stats[i] = algo.get_stats();
+    });
+
+    for (auto i = 0U; i != n_workers; ++i) {
+      state_.results_.merge(std::move(worker_results[i]));
+      worker_stats_ += worker_stats[i];
+    }
+  }
+
+  void search_start_time(Algo& algo,
+                         start_it_t const from_it,
+                         start_it_t const to_it,
+                         pareto_set<journey>& results,
+                         opentelemetry::trace::Span& span) {
+    algo.next_start_time();
+    auto const start_time = from_it->time_at_start_;
+    for (auto const& s : it_range{from_it, to_it}) {
+      trace("init: time_at_start={}, time_at_stop={} at {}\n",
+            s.time_at_start_, s.time_at_stop_, location_idx_t{s.stop_});
+      algo.add_start(s.stop_, s.time_at_stop_);
+    }
+
+    /*
+     * Upper bound: Search journeys faster than 'worst_time_at_dest'
+     * It will not find journeys with the same duration
+     */
+    auto const worst_time_at_dest =
+        start_time + (kFwd ? 1 : -1) *
+                         (std::min(fastest_direct_, q_.max_travel_time_) +
+                          duration_t{1});
+    algo.execute(start_time, q_.max_transfers_, worst_time_at_dest,
+                 q_.prf_idx_, results);
+
+    results.for_each_mutable([&](journey& j) {
+      if (j.legs_.empty() &&
+          (is_ontrip() || search_interval_.contains(j.start_time_)) &&
+          j.travel_time() < fastest_direct_) {
+        try {
+          algo.reconstruct(q_, j);
+        } catch (std::exception const& e) {
+          j.error_ = true;
+          log(log_lvl::error, "search", "reconstruct failed: {}", e.what());
+          span.SetStatus(opentelemetry::trace::StatusCode::kError,
+                         "exception");
+          span.AddEvent("exception",
+                        {{"exception.message",
+                          fmt::format("reconstruct failed: {}", e.what())}});
+        }
+      }
+    });
   }
 
   timetable const& tt_;
@@ -443,6 +534,8 @@ private:
   duration_t fastest_direct_;
   Algo algo_;
   std::optional<std::chrono::seconds> timeout_;
+  std::span<algo_state_t> worker_states_;
+  algo_stats_t worker_stats_{};
 };
 
 }  // namespace nigiri::routing
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "nigiri/routing/tb/tb_data.h"
+
+namespace nigiri::routing::tb {
+
+// Computes the transfers between transports (Witt, "Trip-Based Public
+// Transit Routing", 2015) for the given footpath profile:
+//   - for every transport arrival and every reachable departure (same stop
+//     with its transfer time or via footpath), the earliest transport of each
+//     route is kept, separately for every traffic day
+//   - U-turn transfers (back to the previous stop, where the target could
+//     have been reached directly) are removed
+//   - transfers that do not improve any arrival compared to staying in the
+//     transport (or transferring later) are removed (transfer reduction)
+tb_data preprocess(timetable const&, profile_idx_t = 0U);
+
+}  // namespace nigiri::routing::tb
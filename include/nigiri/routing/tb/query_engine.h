@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "nigiri/routing/clasz_mask.h"
+#include "nigiri/routing/journey.h"
+#include "nigiri/routing/limits.h"
+#include "nigiri/routing/pareto_set.h"
+#include "nigiri/routing/query.h"
+#include "nigiri/routing/tb/tb_data.h"
+#include "nigiri/routing/transfer_time_settings.h"
+#include "nigiri/types.h"
+
+namespace nigiri {
+struct timetable;
+struct rt_timetable;
+}  // namespace nigiri
+
+namespace nigiri::routing::tb {
+
+struct query_stats {
+  std::map<std::string, std::uint64_t> to_map() const {
+    return {
+        {"n_segments_enqueued", n_segments_enqueued_},
+        {"n_segments_pruned", n_segments_pruned_},
+        {"n_transfers_relaxed", n_transfers_relaxed_},
+        {"n_dest_improvements", n_dest_improvements_},
+    };
+  }
+
+  query_stats& operator+=(query_stats const& o) {
+    n_segments_enqueued_ += o.n_segments_enqueued_;
+    n_segments_pruned_ += o.n_segments_pruned_;
+    n_transfers_relaxed_ += o.n_transfers_relaxed_;
+    n_dest_improvements_ += o.n_dest_improvements_;
+    return *this;
+  }
+
+  std::uint64_t n_segments_enqueued_{0ULL};
+  std::uint64_t n_segments_pruned_{0ULL};
+  std::uint64_t n_transfers_relaxed_{0ULL};
+  std::uint64_t n_dest_improvements_{0ULL};
+};
+
+// Transport on traffic day `day_`, entered at stop `from_` and ridden at
+// most until stop `to_ - 1` (from there on, it was reached before).
+struct queue_entry {
+  static constexpr auto const kNoParent =
+      std::numeric_limits<std::uint32_t>::max();
+
+  transport_idx_t t_;
+  day_idx_t day_;
+  stop_idx_t from_, to_;
+  std::uint32_t parent_;    // queue entry of the previous transport
+  stop_idx_t parent_exit_;  // stop where the previous transport was left
+  std::uint32_t start_;     // query_state::starts_ index of the journey start
+};
+
+// First stop at which transport t_ on day day_ was reached. Also covers the
+// later transports of the route for routes in tb_data::fifo_routes_.
+struct reached_entry {
+  transport_idx_t t_;
+  day_idx_t day_;
+  stop_idx_t stop_;
+};
+
+// Transports of a journey found by execute() (for reconstruct()).
+struct journey_transport {
+  transport t_;
+  stop_idx_t enter_, exit_;
+};
+
+struct journey_label {
+  unixtime_t start_time_, dest_time_;
+  location_idx_t dest_;
+  std::uint8_t transfers_;
+  location_idx_t start_location_;
+  unixtime_t time_at_start_location_;
+  std::vector<journey_transport> transports_;
+};
+
+// Working memory of the query engine. Can be reused for all queries on the
+// timetable the transfer set was computed for.
+struct query_state {
+  explicit query_state(tb_data const& tbd) : tbd_{tbd} {}
+
+  tb_data const& tbd_;
+  std::vector<std::pair<location_idx_t, unixtime_t>> starts_;
+  std::vector<queue_entry> q_;
+  std::vector<std::vector<reached_entry>> reached_;
+  std::vector<route_idx_t> reached_routes_;
+  std::vector<std::uint16_t> dest_dist_;
+  std::vector<journey_label> journeys_;
+};
+
+// Trip-based query engine (Witt, "Trip-Based Public Transit Routing", 2015)
+// for search<direction::kForward, query_engine<direction::kForward>>.
+// Supports the clasz and bike transport filters, the wheelchair profile,
+// max. transfers and intermodal start/destination offsets (also time
+// dependent ones). The transfer set (see preprocess()) has to be computed
+// for the query profile. Not supported: real-time updates, via stops,
+// non-default transfer time settings and backward search.
+template <direction SearchDir>
+struct query_engine {
+  static_assert(SearchDir == direction::kForward,
+                "trip-based routing: only forward search is supported");
+
+  using algo_state_t = query_state;
+  using algo_stats_t = query_stats;
+
+  static constexpr bool kUseLowerBounds = false;
+  static constexpr auto const kUnreachable =
+      std::numeric_limits<std::uint16_t>::max();
+  static constexpr auto const kNoEntry =
+      std::numeric_limits<std::uint32_t>::max();
+
+  query_engine(
+      timetable const& tt,
+      rt_timetable const* rtt,
+      query_state& state,
+      bitvec& is_dest,
+      std::array<bitvec, kMaxVias>& is_via,
+      std::vector<std::uint16_t>& dist_to_dest,
+      hash_map<location_idx_t, std::vector<td_offset>> const& td_dist_to_dest,
+      std::vector<std::uint16_t>& lb,
+      std::vector<via_stop> const& via_stops,
+      day_idx_t base,
+      clasz_mask_t allowed_claszes,
+      bool require_bike_transport,
+      bool is_wheelchair,
+      transfer_time_settings const& tts);
+
+  algo_stats_t get_stats() const { return stats_; }
+
+  void reset_arrivals() { time_at_dest_.fill(unixtime_t::max()); }
+
+  void next_start_time() { state_.starts_.clear(); }
+
+  void add_start(location_idx_t const l, unixtime_t const t) {
+    state_.starts_.emplace_back(l, t);
+  }
+
+  void execute(unixtime_t start_time,
+               std::uint8_t max_transfers,
+               unixtime_t worst_time_at_dest,
+               profile_idx_t,
+               pareto_set<journey>& results);
+
+  void reconstruct(query const&, journey&) const;
+
+private:
+  struct dest_label {
+    unixtime_t time_{unixtime_t::max()};
+    std::uint32_t entry_{kNoEntry};
+    stop_idx_t exit_{0U};
+  };
+
+  bool is_route_allowed(route_idx_t) const;
+  void reset_reached();
+  void enqueue_first(std::uint32_t start_idx);
+  void enqueue(transport_idx_t,
+               day_idx_t,
+               stop_idx_t,
+               std::uint32_t parent,
+               stop_idx_t parent_exit,
+               std::uint32_t start_idx);
+  void check_dest(unsigned k, std::uint32_t entry);
+  void relax_transfers(unsigned k, std::uint32_t entry);
+  void update_time_at_dest(unsigned k, unixtime_t);
+  location_idx_t get_dest(location_idx_t exit,
+                          unixtime_t arr,
+                          unixtime_t dest_time) const;
+  journey_label make_label(unixtime_t start_time,
+                           std::uint8_t transfers,
+                           dest_label const&) const;
+
+  timetable const& tt_;
+  query_state& state_;
+  tb_data const& tbd_;
+  bitvec const& is_dest_;
+  std::vector<std::uint16_t> const& dist_to_end_;
+  hash_map<location_idx_t, std::vector<td_offset>> const& td_dist_to_end_;
+
+  // Duration from arriving at a stop to the destination (without transfer).
+  std::vector<std::uint16_t> const& dest_dist_;
+
+  clasz_mask_t allowed_claszes_;
+  bool require_bike_transport_;
+  bool is_wheelchair_;
+  std::array<unixtime_t, kMaxTransfers + 1U> time_at_dest_;
+  std::array<dest_label, kMaxTransfers + 1U> best_;
+  query_stats stats_;
+};
+
+}  // namespace nigiri::routing::tb
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <filesystem>
+
+#include "cista/memory_holder.h"
+
+#include "nigiri/types.h"
+
+namespace nigiri {
+struct timetable;
+}
+
+namespace nigiri::routing::tb {
+
+// Segment = (transport, stop index), numbered consecutively per transport.
+using segment_idx_t = cista::strong<std::uint32_t, struct _segment_idx>;
+
+// Transfer from a transport arriving at a stop to another transport
+// departing from the same or a nearby stop (trip-based routing).
+struct transfer {
+  transport_idx_t to_transport_;
+  stop_idx_t to_stop_idx_;
+
+  // Start day of the target transport relative to the start day of the
+  // source transport.
+  std::int8_t day_offset_;
+
+  // Start days of the source transport on which the transfer is valid.
+  bitfield_idx_t traffic_days_;
+};
+
+// Transfer set for trip-based routing. Only depends on the timetable and
+// can be computed once, serialized and loaded next to the timetable.
+struct tb_data {
+  segment_idx_t get_segment(transport_idx_t const t,
+                            stop_idx_t const stop_idx) const {
+    return segment_idx_t{to_idx(transport_first_segment_[t]) + stop_idx};
+  }
+
+  void write(std::filesystem::path const&) const;
+  static cista::wrapped<tb_data> read(std::filesystem::path const&);
+
+  // Footpath profile the transfers were computed for.
+  profile_idx_t prf_idx_{0U};
+
+  vector_map<transport_idx_t, segment_idx_t> transport_first_segment_;
+  vecvec<segment_idx_t, transfer> segment_transfers_;
+  vector_map<bitfield_idx_t, bitfield> bitfields_;
+
+  // Set for routes where a later transport (same start day) never departs
+  // or arrives earlier at any stop. For these routes, reaching a transport
+  // at a stop also marks all later transports as reached.
+  bitvec_map<route_idx_t> fifo_routes_;
+};
+
+}  // namespace nigiri::routing::tb
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "nigiri/routing/search.h"
+#include "nigiri/routing/tb/query_engine.h"
+
+namespace nigiri::routing::tb {
+
+// Forward search with the trip-based query engine. q_state has to be
+// created for a transfer set computed with the query profile.
+routing_result<query_stats> tb_search(timetable const&,
+                                      search_state&,
+                                      query_state&,
+                                      query);
+
+}  // namespace nigiri::routing::tb
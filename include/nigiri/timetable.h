@@ -3,9 +3,11 @@
 #include <utl/get_or_create.h>
 #include <utl/pipes/for_each.h>
 #include <filesystem>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <type_traits>
+#include <vector>
 
 #include "utl/verify.h"
 #include "utl/zip.h"
@@ -24,7 +26,10 @@
 #include "loader/gtfs/stop.h"
 #include "tg.h"
 
+#include "nigiri/common/compressed_bitfield.h"
 #include "nigiri/common/interval.h"
+#include "nigiri/common/perfect_hash.h"
+#include "nigiri/common/string_store.h"
 #include "nigiri/footpath.h"
 #include "nigiri/geometry.h"
 #include "nigiri/location.h"
@@ -35,6 +40,24 @@
 
 namespace nigiri {
 
+struct timetable_read_options {
+  // Back the timetable memory with transparent huge pages (fewer TLB misses).
+  bool huge_pages_{false};
+
+  // Fault in the data used by routing (routes, stop times, footpaths,
+  // traffic days) while loading instead of during the first queries.
+  // Only has an effect for mapped_timetable: timetable::read() reads the
+  // whole file into memory, which already faults in every page.
+  bool prefault_{false};
+
+  // Pin the data used by routing in memory (mlock, needs RLIMIT_MEMLOCK).
+  bool lock_{false};
+
+  // Only keep these days (see restrict_to_window). The remaining timetable is
+  // copied out of the file buffer, which is released afterwards.
+  std::optional<interval<date::sys_days>> date_window_;
+};
+
 struct timetable {
   struct locations {
     timezone_idx_t register_timezone(timezone tz) {
@@ -110,9 +133,31 @@ struct timetable {
 
     void resolve_timezones();
 
+    vecvec<location_idx_t, footpath>::const_bucket footpaths_out(
+        profile_idx_t const prf_idx, location_idx_t const l) const {
+      return resolve_footpaths(footpaths_out_, has_own_footpaths_out_,
+                               prf_idx, l);
+    }
+
+    vecvec<location_idx_t, footpath>::const_bucket footpaths_in(
+        profile_idx_t const prf_idx, location_idx_t const l) const {
+      return resolve_footpaths(footpaths_in_, has_own_footpaths_in_, prf_idx,
+                               l);
+    }
+
+    static vecvec<location_idx_t, footpath>::const_bucket resolve_footpaths(
+        array<vecvec<location_idx_t, footpath>, kMaxProfiles> const& fps,
+        array<bitvec_map<location_idx_t>, kMaxProfiles> const& has_own,
+        profile_idx_t const prf_idx,
+        location_idx_t const l) {
+      auto const& own = has_own[prf_idx];
+      return fps[own.size() == 0U || own.test(l) ? prf_idx
+                                                 : profile_idx_t{0U}][l];
+    }
+
     // Station access: external station id -> internal station idx
     hash_map<location_id, location_idx_t> location_id_to_idx_;
-    vecvec<location_idx_t, char> names_;
+    string_store<location_idx_t> names_;
     vecvec<location_idx_t, char> ids_;
     vector_map<location_idx_t, geo::latlng> coordinates_;
     vector_map<location_idx_t, source_idx_t> src_;
@@ -126,6 +171,23 @@ struct timetable {
     mutable_fws_multimap<location_idx_t, footpath> preprocessing_footpaths_in_;
     array<vecvec<location_idx_t, footpath>, kMaxProfiles> footpaths_out_;
     array<vecvec<location_idx_t, footpath>, kMaxProfiles> footpaths_in_;
+
+    // Override layer for profiles != 0 (see deduplicate_footpath_profiles).
+    // Empty: footpaths_out_/footpaths_in_ of the profile are a full copy.
+    // Otherwise, only locations with the bit set store their own footpaths,
+    // all other locations use the footpaths of profile 0.
+    // Use footpaths_out()/footpaths_in() to resolve this.
+    array<bitvec_map<location_idx_t>, kMaxProfiles> has_own_footpaths_out_;
+    array<bitvec_map<location_idx_t>, kMaxProfiles> has_own_footpaths_in_;
+
+    // Time-dependent footpaths (e.g. elevator schedules, opening hours).
+    // For a profile != 0, they replace footpaths_out_/footpaths_in_ at all
+    // locations with has_td_footpaths_out_/has_td_footpaths_in_ set.
+    // Time-dependent footpaths of an rt_timetable take precedence.
+    array<bitvec_map<location_idx_t>, kMaxProfiles> has_td_footpaths_out_;
+    array<bitvec_map<location_idx_t>, kMaxProfiles> has_td_footpaths_in_;
+    array<vecvec<location_idx_t, td_footpath>, kMaxProfiles> td_footpaths_out_;
+    array<vecvec<location_idx_t, td_footpath>, kMaxProfiles> td_footpaths_in_;
     vector_map<timezone_idx_t, timezone> timezones_;
   } locations_;
 
@@ -411,11 +473,31 @@ struct timetable {
   }
 
   bitfield_idx_t register_bitfield(bitfield const& b) {
+    assert(!has_compressed_bitfields());
     auto const idx = bitfield_idx_t{bitfields_.size()};
     bitfields_.emplace_back(b);
     return idx;
   }
 
+  bool has_compressed_bitfields() const {
+    return compressed_bitfields_.size() != 0U;
+  }
+
+  std::size_t n_bitfields() const {
+    return has_compressed_bitfields() ? compressed_bitfields_.size()
+                                      : bitfields_.size();
+  }
+
+  bitfield traffic_days(bitfield_idx_t const i) const {
+    return has_compressed_bitfields() ? compressed_bitfields_.get(i)
+                                      : bitfields_[i];
+  }
+
+  bool is_traffic_day(bitfield_idx_t const i, std::size_t const day) const {
+    return has_compressed_bitfields() ? compressed_bitfields_.test(i, day)
+                                      : bitfields_[i].test(day);
+  }
+
   template <typename T>
   trip_direction_string_idx_t register_trip_direction_string(T&& s) {
     auto const idx =
@@ -514,9 +596,11 @@ struct timetable {
     return transport_idx_t{transport_traffic_days_.size()};
   }
 
+  // Only for uncompressed stop times (see the overload with buffer below).
   std::span<delta const> event_times_at_stop(route_idx_t const r,
                                              stop_idx_t const stop_idx,
                                              event_type const ev_type) const {
+    assert(!has_compressed_stop_times());
     auto const n_transports =
         static_cast<unsigned>(route_transport_ranges_[r].size());
     auto const idx = static_cast<unsigned>(
@@ -525,10 +609,27 @@ struct timetable {
     return std::span<delta const>{&route_stop_times_[idx], n_transports};
   }
 
+  // With compressed stop times, the event times are decoded into buf and
+  // the returned span points to it (valid until buf is modified). Otherwise,
+  // buf is not used and the span points into route_stop_times_.
+  std::span<delta const> event_times_at_stop(route_idx_t const r,
+                                             stop_idx_t const stop_idx,
+                                             event_type const ev_type,
+                                             std::vector<delta>& buf) const {
+    if (has_compressed_stop_times()) {
+      return decompress_event_times(r, stop_idx, ev_type, buf);
+    }
+    return event_times_at_stop(r, stop_idx, ev_type);
+  }
+
   delta event_mam(route_idx_t const r,
                   transport_idx_t t,
                   stop_idx_t const stop_idx,
                   event_type const ev_type) const {
+    if (has_compressed_stop_times()) {
+      return compressed_event_mam(
+          r, t, stop_idx * 2U - (ev_type == event_type::kArr ? 1U : 0U));
+    }
     auto const range = route_transport_ranges_[r];
     auto const n_transports = static_cast<unsigned>(range.size());
     auto const route_stop_begin = static_cast<unsigned>(
@@ -538,6 +639,42 @@ struct timetable {
     return route_stop_times_[route_stop_begin + t_idx_in_route];
   }
 
+  bool has_frequency_runs(route_idx_t const r) const {
+    return to_idx(r) < route_frequency_runs_.size() &&
+           route_frequency_runs_[r].size() != 0U;
+  }
+
+  bool has_compressed_stop_times() const {
+    return !compressed_first_dep_.empty();
+  }
+
+  // Event `event_idx` (= stop_idx * 2 - (arrival ? 1 : 0)) of transport t.
+  delta compressed_event_mam(route_idx_t const r,
+                             transport_idx_t const t,
+                             unsigned const event_idx) const {
+    auto const n_events =
+        static_cast<unsigned>(route_location_seq_[r].size() * 2U - 2U);
+    auto const offset = compressed_profiles_
+        [compressed_route_profiles_[r] +
+         compressed_profile_idx_[t] * n_events + event_idx];
+    return delta{
+        static_cast<std::uint16_t>(compressed_first_dep_[t].count() + offset)};
+  }
+
+  std::span<delta const> decompress_event_times(
+      route_idx_t const r,
+      stop_idx_t const stop_idx,
+      event_type const ev_type,
+      std::vector<delta>& buf) const {
+    auto const event_idx =
+        stop_idx * 2U - (ev_type == event_type::kArr ? 1U : 0U);
+    buf.clear();
+    for (auto const t : route_transport_ranges_[r]) {
+      buf.push_back(compressed_event_mam(r, t, event_idx));
+    }
+    return buf;
+  }
+
   delta event_mam(transport_idx_t t,
                   stop_idx_t const stop_idx,
                   event_type const ev_type) const {
@@ -609,15 +746,39 @@ struct timetable {
                         }});
   }
 
+  // Has to be called after sorting trip_id_to_idx_ by (source, trip id).
+  // trip_id_to_idx_ must not change afterwards (the index stores positions).
+  // If the index cannot be built, find_trip_id() uses binary search.
+  void build_trip_id_index();
+
+  // First entry of trip_id_to_idx_ with the given source and trip id
+  // (followed by all other entries with this id) or end(trip_id_to_idx_).
+  vector<pair<trip_id_idx_t, trip_idx_t>>::const_iterator find_trip_id(
+      source_idx_t, std::string_view trip_id) const;
+
+  // Cold data: empty if the timetable was read from a hot file (use
+  // lazy_cold_data from timetable_cold_data.h instead).
+  bool has_cold_data(trip_idx_t const trip_idx) const {
+    return to_idx(trip_idx) < trip_display_names_.size() &&
+           to_idx(trip_idx) < trip_debug_.size();
+  }
+
+  std::string_view trip_display_name(trip_idx_t const trip_idx) const {
+    return has_cold_data(trip_idx) ? trip_display_names_[trip_idx].view()
+                                   : std::string_view{};
+  }
+
   std::string_view transport_name(transport_idx_t const t) const {
-    return trip_display_names_
-        [merged_trips_[transport_to_trip_section_[t].front()].front()]
-            .view();
+    return trip_display_name(
+        merged_trips_[transport_to_trip_section_[t].front()].front());
   }
 
   debug dbg(transport_idx_t const t) const {
     auto const trip_idx =
         merged_trips_[transport_to_trip_section_[t].front()].front();
+    if (!has_cold_data(trip_idx) || trip_debug_[trip_idx].empty()) {
+      return debug{};
+    }
     return debug{
         source_file_names_[trip_debug_[trip_idx].front().source_file_idx_]
             .view(),
@@ -630,18 +791,83 @@ struct timetable {
   void write(cista::memory_holder&) const;
   void write(std::filesystem::path const&) const;
   static cista::wrapped<timetable> read(std::filesystem::path const&);
+  static cista::wrapped<timetable> read(std::filesystem::path const&,
+                                        timetable_read_options const&);
+
+  // Prefaults and/or locks the routing sections (see timetable_read_options).
+  void advise_routing_data(timetable_read_options const&) const;
+
+  // Assigns a new id_. Has to be called after changing the routing data of
+  // a timetable that might have been used for routing already.
+  void renew_id() { id_ = make_id(); }
+  static std::uint64_t make_id();
+
+  // Calls fn(data, size_in_bytes) for every memory region accessed by routing.
+  template <typename Fn>
+  void for_each_routing_section(Fn&& fn) const {
+    auto const add = [&](auto const& v) {
+      fn(static_cast<void const*>(v.data()), v.size() * sizeof(*v.data()));
+    };
+    auto const add_vecvec = [&](auto const& vv) {
+      add(vv.bucket_starts_);
+      add(vv.data_);
+    };
+
+    add(route_stop_times_);
+    add(route_stop_time_ranges_);
+    add(compressed_first_dep_);
+    add(compressed_profile_idx_);
+    add(compressed_route_profiles_);
+    add(compressed_profiles_);
+    add_vecvec(route_frequency_runs_);
+    add(route_transport_ranges_);
+    add(route_clasz_);
+    add(route_bikes_allowed_.blocks_);
+    add_vecvec(route_location_seq_);
+    add_vecvec(location_routes_);
+    add(transport_route_);
+    add(transport_traffic_days_);
+    add(bitfields_);
+    add(compressed_bitfields_.entries_);
+    add_vecvec(compressed_bitfields_.exceptions_);
+    add(locations_.transfer_time_);
+    for (auto const& fps : locations_.footpaths_out_) {
+      add_vecvec(fps);
+    }
+    for (auto const& fps : locations_.footpaths_in_) {
+      add_vecvec(fps);
+    }
+    for (auto const& own : locations_.has_own_footpaths_out_) {
+      add(own.blocks_);
+    }
+    for (auto const& own : locations_.has_own_footpaths_in_) {
+      add(own.blocks_);
+    }
+    add_vecvec(fwd_search_lb_graph_);
+    add_vecvec(bwd_search_lb_graph_);
+  }
+
+  // Identifies the routing data for caches that outlive a single search
+  // (e.g. routing::active_transports). Random instead of the address: a
+  // timetable can be loaded or allocated where a previous one was.
+  std::uint64_t id_{make_id()};
 
   // Schedule range.
   interval<date::sys_days> date_range_;
 
   // Trip access: external trip id -> internal trip index
+  // Sorted by (source, trip id) and immutable after finalize().
   vector<pair<trip_id_idx_t, trip_idx_t>> trip_id_to_idx_;
 
+  // (source, trip id) -> first matching entry in trip_id_to_idx_
+  perfect_hash_index trip_id_index_;
+
   // Trip index -> list of external trip ids
   mutable_fws_multimap<trip_idx_t, trip_id_idx_t> trip_ids_;
 
-  // Storage for trip id strings + source
-  vecvec<trip_id_idx_t, char> trip_id_strings_;
+  // Storage for trip id strings + source (the same id can be registered
+  // for several trips, e.g. HRD train numbers with different traffic days)
+  string_store<trip_id_idx_t> trip_id_strings_;
   vector_map<trip_id_idx_t, source_idx_t> trip_id_src_;
 
   // Trip train number, if available (otherwise 0)
@@ -663,7 +889,7 @@ struct timetable {
   vecvec<source_file_idx_t, char> source_file_names_;
 
   // Trip index -> display name
-  vecvec<trip_idx_t, char> trip_display_names_;
+  string_store<trip_idx_t> trip_display_names_;
 
   // Route -> range of transports in this route (from/to transport_idx_t)
   vector_map<route_idx_t, interval<transport_idx_t>> route_transport_ranges_;
@@ -700,6 +926,22 @@ struct timetable {
   vector_map<route_idx_t, interval<std::uint32_t>> route_stop_time_ranges_;
   vector<delta> route_stop_times_;
 
+  // Optional compressed form of route_stop_times_ (see
+  // loader::compress_route_stop_times). If set, route_stop_times_ and
+  // route_stop_time_ranges_ are empty.
+  // Transports of a route share stop time profiles: the offsets (in minutes,
+  // modulo 2^16) of all events of a transport relative to its first
+  // departure, in the order dep(0), arr(1), dep(1), ..., arr(n-1).
+  // event time = first departure of the transport + offset from its profile
+  vector_map<transport_idx_t, delta> compressed_first_dep_;
+  vector_map<transport_idx_t, std::uint16_t> compressed_profile_idx_;
+  vector_map<route_idx_t, std::uint32_t> compressed_route_profiles_;
+  vector<std::uint16_t> compressed_profiles_;
+
+  // Route -> partition of its transports into frequency runs (see
+  // loader::build_frequency_runs). Empty for routes without long runs.
+  vecvec<route_idx_t, frequency_run> route_frequency_runs_;
+
   // Offset between the stored time and the time given in the GTFS timetable.
   // Required to match GTFS-RT with GTFS-static trips.
   vector_map<transport_idx_t, duration_t> transport_first_dep_offset_;
@@ -714,8 +956,11 @@ struct timetable {
   // Trip index -> traffic day bitfield
   vector_map<transport_idx_t, bitfield_idx_t> transport_traffic_days_;
 
-  // Unique bitfields
+  // Unique bitfields. Empty after loader::compress_bitfields(), then
+  // compressed_bitfields_ holds the traffic days.
+  // Use traffic_days() / is_traffic_day() to read either of them.
   vector_map<bitfield_idx_t, bitfield> bitfields_;
+  compressed_bitfields compressed_bitfields_;
 
   // For each trip the corresponding route
   vector_map<transport_idx_t, route_idx_t> transport_route_;
@@ -730,7 +975,7 @@ struct timetable {
   vector_map<attribute_idx_t, attribute> attributes_;
   vecvec<attribute_combination_idx_t, attribute_idx_t> attribute_combinations_;
   vector_map<provider_idx_t, provider> providers_;
-  vecvec<trip_direction_string_idx_t, char> trip_direction_strings_;
+  string_store<trip_direction_string_idx_t> trip_direction_strings_;
   vector_map<trip_direction_idx_t, trip_direction_t> trip_directions_;
   vecvec<trip_line_idx_t, char> trip_lines_;
 
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+#include "cista/memory_holder.h"
+
+#include "nigiri/common/string_store.h"
+#include "nigiri/types.h"
+
+namespace nigiri {
+
+struct timetable;
+
+// Metadata not needed for routing (debug info, source file names, display
+// names). Stored in a separate file by write_hot_cold() so that servers
+// only read the (smaller) hot timetable at startup.
+struct timetable_cold_data {
+  mutable_fws_multimap<trip_idx_t, trip_debug> trip_debug_;
+  vecvec<source_file_idx_t, char> source_file_names_;
+  string_store<trip_idx_t> trip_display_names_;
+};
+
+// Writes the timetable without its cold data to `hot` (readable with
+// timetable::read) and the cold data to `cold`. The cold data is moved out
+// of the timetable for writing and moved back afterwards.
+void write_hot_cold(timetable&,
+                    std::filesystem::path const& hot,
+                    std::filesystem::path const& cold);
+
+// Cold data of a timetable read from a hot file. The cold data file is read
+// on the first call of an accessor. The timetable is not modified (its own
+// cold accessors keep returning empty values), so the accessors can be used
+// concurrently with routing and with each other. Has to outlive the returned
+// string views.
+struct lazy_cold_data {
+  lazy_cold_data(std::filesystem::path, timetable const&);
+
+  // Thread safe, only the first call reads the file.
+  timetable_cold_data const& get() const;
+
+  std::string_view trip_display_name(trip_idx_t) const;
+  std::string_view transport_name(transport_idx_t) const;
+  debug dbg(transport_idx_t) const;
+
+  bool is_loaded() const;
+
+private:
+  std::filesystem::path path_;
+  timetable const& tt_;
+  mutable std::once_flag once_;
+  mutable std::atomic_bool loaded_{false};
+  mutable std::optional<cista::wrapped<timetable_cold_data>> data_;
+};
+
+}  // namespace nigiri
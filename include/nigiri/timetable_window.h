@@ -0,0 +1,21 @@
+#pragma once
+
+#include "date/date.h"
+
+#include "nigiri/common/interval.h"
+
+namespace nigiri {
+
+struct timetable;
+
+// Restricts the timetable to the days of `window` (which has to be part of
+// tt.date_range_). Traffic day bitfields are shifted to the new
+// internal_interval_days() and deduplicated. Transports without any traffic
+// day left are removed (transport indices are compacted). Routes keep their
+// indices but routes without transports are removed from location_routes_.
+//
+// This allows to import and serialize a wide date range once and to only
+// keep a few days in memory at runtime (see timetable_read_options).
+void restrict_to_window(timetable&, interval<date::sys_days> window);
+
+}  // namespace nigiri
@@ -523,6 +523,15 @@ inline void serialize(Ctx&, delta const*, cista::offset_t const) {}
 template <typename Ctx>
 inline void deserialize(Ctx const&, delta*) {}
 
+// Transports [from_, from_ + n_) (offsets within their route) with identical
+// travel times, each departing headway_ minutes after the previous one
+// (frequency based service, e.g. expanded from GTFS frequencies.txt).
+struct frequency_run {
+  std::uint32_t from_;
+  std::uint32_t n_;
+  std::uint16_t headway_;
+};
+
 inline local_time to_local_time_offsets(tz_offsets const& offsets,
                                         unixtime_t const t) {
   auto const active_season_it =
@@ -164,7 +164,7 @@ bool nigiri_is_transport_active(const nigiri_timetable_t* t,
                                 const uint32_t transport_idx,
                                 uint16_t day_idx) {
   auto const tidx = nigiri::transport_idx_t{transport_idx};
-  return t->tt->bitfields_[t->tt->transport_traffic_days_[tidx]].test(day_idx);
+  return t->tt->is_traffic_day(t->tt->transport_traffic_days_[tidx], day_idx);
 }
 
 uint32_t nigiri_get_route_count(const nigiri_timetable_t* t) {
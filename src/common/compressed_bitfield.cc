@@ -0,0 +1,100 @@
+#include "nigiri/common/compressed_bitfield.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+namespace nigiri {
+
+compressed_bitfield compressed_bitfield::compress(bitfield const& bf) {
+  auto c = compressed_bitfield{};
+
+  auto first = std::optional<std::size_t>{};
+  auto last = std::size_t{0U};
+  for (auto i = 0U; i != kMaxDays; ++i) {
+    if (bf.test(i)) {
+      if (!first.has_value()) {
+        first = i;
+      }
+      last = i;
+    }
+  }
+
+  if (!first.has_value()) {
+    return c;
+  }
+
+  c.from_ = static_cast<std::uint16_t>(*first);
+  c.to_ = static_cast<std::uint16_t>(last + 1U);
+
+  // Majority vote per weekday minimizes the number of exceptions.
+  auto active = std::array<unsigned, 7U>{};
+  auto inactive = std::array<unsigned, 7U>{};
+  for (auto i = std::size_t{c.from_}; i != c.to_; ++i) {
+    ++(bf.test(i) ? active : inactive)[i % 7U];
+  }
+  for (auto w = 0U; w != 7U; ++w) {
+    if (active[w] > inactive[w]) {
+      c.weekdays_ |= static_cast<std::uint8_t>(1U << w);
+    }
+  }
+
+  for (auto i = std::size_t{c.from_}; i != c.to_; ++i) {
+    auto const by_pattern = ((c.weekdays_ >> (i % 7U)) & 1U) != 0U;
+    if (by_pattern != bf.test(i)) {
+      c.exceptions_.push_back(static_cast<std::uint16_t>(i));
+    }
+  }
+
+  return c;
+}
+
+bitfield compressed_bitfield::decompress() const {
+  auto bf = bitfield{};
+  for (auto i = std::size_t{from_}; i != to_; ++i) {
+    bf.set(i, ((weekdays_ >> (i % 7U)) & 1U) != 0U);
+  }
+  for (auto const e : exceptions_) {
+    bf.set(e, !bf.test(e));
+  }
+  return bf;
+}
+
+bool compressed_bitfield::is_exception(std::size_t const day) const {
+  return std::binary_search(begin(exceptions_), end(exceptions_),
+                            static_cast<std::uint16_t>(day));
+}
+
+std::size_t compressed_bitfield::count() const {
+  auto n = std::size_t{0U};
+  for (auto i = std::size_t{from_}; i != to_; ++i) {
+    n += test(i) ? 1U : 0U;
+  }
+  return n;
+}
+
+std::size_t compressed_bitfield::size_bytes() const {
+  return sizeof(compressed_bitfield) +
+         exceptions_.allocated_size_ * sizeof(std::uint16_t);
+}
+
+bitfield compressed_bitfields::get(bitfield_idx_t const i) const {
+  auto const& e = entries_[i];
+  auto bf = bitfield{};
+  for (auto day = std::size_t{e.from_}; day != e.to_; ++day) {
+    bf.set(day, ((e.weekdays_ >> (day % 7U)) & 1U) != 0U);
+  }
+  for (auto const x : exceptions_[i]) {
+    bf.set(x, !bf.test(x));
+  }
+  return bf;
+}
+
+std::size_t compressed_bitfields::size_bytes() const {
+  return entries_.size() * sizeof(entry) +
+         exceptions_.bucket_starts_.size() *
+             sizeof(decltype(exceptions_.bucket_starts_)::value_type) +
+         exceptions_.data_.size() * sizeof(std::uint16_t);
+}
+
+}  // namespace nigiri
@@ -0,0 +1,71 @@
+#include "nigiri/common/memory_usage.h"
+
+#if defined(__linux__)
+#include <cstdio>
+#include <cstring>
+#elif !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace nigiri {
+
+allocation_counters& get_allocation_counters() {
+  static auto counters = allocation_counters{};
+  return counters;
+}
+
+void enable_allocation_counting() {
+  get_allocation_counters().enabled_.store(true, std::memory_order_relaxed);
+}
+
+memory_usage get_memory_usage() {
+  auto m = memory_usage{};
+
+#if defined(__linux__)
+  // VmRSS = current resident set size, VmHWM = peak resident set size
+  if (auto* const f = std::fopen("/proc/self/status", "r"); f != nullptr) {
+    char line[256];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+      auto kb = 0UL;
+      if (std::strncmp(line, "VmRSS:", 6) == 0 &&
+          std::sscanf(line + 6, "%lu", &kb) == 1) {
+        m.current_rss_ = kb * 1024U;
+      } else if (std::strncmp(line, "VmHWM:", 6) == 0 &&
+                 std::sscanf(line + 6, "%lu", &kb) == 1) {
+        m.peak_rss_ = kb * 1024U;
+      }
+    }
+    std::fclose(f);
+  }
+#elif !defined(_WIN32)
+  auto r = rusage{};
+  if (getrusage(RUSAGE_SELF, &r) == 0) {
+#if defined(__APPLE__)
+    m.peak_rss_ = static_cast<std::size_t>(r.ru_maxrss);
+#else
+    m.peak_rss_ = static_cast<std::size_t>(r.ru_maxrss) * 1024U;
+#endif
+  }
+#endif
+
+  auto const& c = get_allocation_counters();
+  m.n_allocations_ = c.n_allocations_.load(std::memory_order_relaxed);
+  m.allocated_bytes_ = c.allocated_bytes_.load(std::memory_order_relaxed);
+
+  return m;
+}
+
+bool reset_peak_rss() {
+#if defined(__linux__)
+  auto* const f = std::fopen("/proc/self/clear_refs", "w");
+  if (f == nullptr) {
+    return false;
+  }
+  auto const success = std::fputs("5", f) >= 0;
+  return std::fclose(f) == 0 && success;
+#else
+  return false;
+#endif
+}
+
+}  // namespace nigiri
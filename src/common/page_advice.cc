@@ -0,0 +1,83 @@
+#include "nigiri/common/page_advice.h"
+
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace nigiri {
+
+#if defined(__linux__)
+
+namespace {
+
+std::uintptr_t page_size() {
+  static auto const size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+std::uintptr_t page_floor(std::uintptr_t const x) {
+  return x & ~(page_size() - 1U);
+}
+
+std::uintptr_t page_ceil(std::uintptr_t const x) {
+  return page_floor(x + page_size() - 1U);
+}
+
+}  // namespace
+
+bool advise_huge_pages(void const* data, std::size_t const size) {
+  // Only pages exclusively owned by the range (the allocation might share
+  // its first/last page with other data).
+  auto const from = page_ceil(reinterpret_cast<std::uintptr_t>(data));
+  auto const to = page_floor(reinterpret_cast<std::uintptr_t>(data) + size);
+  if (from >= to) {
+    return false;
+  }
+#if defined(MADV_HUGEPAGE)
+  return madvise(reinterpret_cast<void*>(from), to - from, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
+bool prefault_pages(void const* data, std::size_t const size) {
+  if (size == 0U) {
+    return true;
+  }
+  auto const from = page_floor(reinterpret_cast<std::uintptr_t>(data));
+  auto const to = page_ceil(reinterpret_cast<std::uintptr_t>(data) + size);
+  auto const ok =
+      madvise(reinterpret_cast<void*>(from), to - from, MADV_WILLNEED) == 0;
+
+  auto const* const first = static_cast<unsigned char const*>(data);
+  auto sum = 0U;
+  for (auto offset = std::size_t{0U}; offset < size; offset += page_size()) {
+    sum += *static_cast<unsigned char const volatile*>(first + offset);
+  }
+  sum += *static_cast<unsigned char const volatile*>(first + size - 1U);
+  static_cast<void>(sum);
+
+  return ok;
+}
+
+bool lock_pages(void const* data, std::size_t const size) {
+  if (size == 0U) {
+    return true;
+  }
+  auto const from = page_floor(reinterpret_cast<std::uintptr_t>(data));
+  auto const to = page_ceil(reinterpret_cast<std::uintptr_t>(data) + size);
+  return mlock(reinterpret_cast<void const*>(from), to - from) == 0;
+}
+
+#else
+
+bool advise_huge_pages(void const*, std::size_t) { return false; }
+bool prefault_pages(void const*, std::size_t) { return false; }
+bool lock_pages(void const*, std::size_t) { return false; }
+
+#endif
+
+}  // namespace nigiri
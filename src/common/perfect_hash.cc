@@ -0,0 +1,82 @@
+#include "nigiri/common/perfect_hash.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace nigiri {
+
+bool perfect_hash_index::build(
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> const& entries) {
+  seeds_.clear();
+  values_.clear();
+  if (entries.empty()) {
+    return true;
+  }
+
+  auto const n = entries.size();
+  seeds_.resize(n / 2U + 1U);
+  values_.resize(n);
+
+  auto hashes = std::vector<std::uint64_t>(n);
+  for (auto i = 0U; i != n; ++i) {
+    hashes[i] = entries[i].first;
+  }
+  std::sort(begin(hashes), end(hashes));
+  if (std::adjacent_find(begin(hashes), end(hashes)) != end(hashes)) {
+    seeds_.clear();
+    values_.clear();
+    return false;
+  }
+
+  // Entries grouped by bucket, largest buckets first: they are the hardest
+  // to place and should go into the still empty table.
+  auto bucket_size = std::vector<std::uint32_t>(seeds_.size());
+  for (auto const& [h, _] : entries) {
+    ++bucket_size[bucket(h)];
+  }
+  auto order = std::vector<std::pair<std::uint64_t, std::uint32_t>>(n);
+  for (auto i = 0U; i != n; ++i) {
+    auto const b = bucket(entries[i].first);
+    order[i] = {(std::uint64_t{~bucket_size[b]} << 32U) | b, i};
+  }
+  std::sort(begin(order), end(order));
+
+  auto taken = std::vector<bool>(n);
+  auto slots = std::vector<std::size_t>{};
+  for (auto from = 0U; from != n;) {
+    auto const b = bucket(entries[order[from].second].first);
+    auto const to = from + bucket_size[b];
+
+    for (auto seed = std::uint32_t{0U};; ++seed) {
+      slots.clear();
+      for (auto i = from; i != to; ++i) {
+        auto const s = slot(entries[order[i].second].first, seed);
+        if (taken[s] || std::find(begin(slots), end(slots), s) != end(slots)) {
+          break;
+        }
+        slots.emplace_back(s);
+      }
+
+      if (slots.size() == to - from) {
+        seeds_[b] = seed;
+        for (auto i = from; i != to; ++i) {
+          taken[slots[i - from]] = true;
+          values_[slots[i - from]] = entries[order[i].second].second;
+        }
+        break;
+      }
+
+      if (seed == std::numeric_limits<std::uint32_t>::max()) {
+        seeds_.clear();
+        values_.clear();
+        return false;
+      }
+    }
+
+    from = to;
+  }
+
+  return true;
+}
+
+}  // namespace nigiri
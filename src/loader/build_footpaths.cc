@@ -1,5 +1,6 @@
 #include "nigiri/loader/build_footpaths.h"
 
+#include <algorithm>
 #include <mutex>
 #include <optional>
 #include <stack>
@@ -409,6 +410,7 @@ void build_footpaths(timetable& tt, finalize_options const opt) {
   add_links_to_and_between_children(tt);
   link_nearby_stations(tt);
   if (opt.merge_dupes_intra_src_ || opt.merge_dupes_inter_src_) {
+    auto const timer = scoped_timer{"loader.merge_duplicates"};
     for (auto l = location_idx_t{0U}; l != tt.n_locations(); ++l) {
       if (tt.locations_.src_[l] == source_idx_t{source_idx_t::invalid()}) {
         continue;
@@ -431,4 +433,58 @@ void build_footpaths(timetable& tt, finalize_options const opt) {
   write_footpaths(tt);
 }
 
+namespace {
+
+std::size_t deduplicate_profile(
+    array<vecvec<location_idx_t, footpath>, kMaxProfiles>& footpaths,
+    array<bitvec_map<location_idx_t>, kMaxProfiles>& has_own,
+    profile_idx_t const prf_idx) {
+  auto const& base = footpaths[0U];
+  auto& fps = footpaths[prf_idx];
+  auto& own = has_own[prf_idx];
+  if (fps.empty() || own.size() != 0U) {
+    return 0U;  // unused or already deduplicated
+  }
+
+  utl::verify(fps.size() == base.size(),
+              "deduplicate_footpath_profiles: profile {} covers {} locations, "
+              "profile 0 covers {}",
+              static_cast<int>(prf_idx), fps.size(), base.size());
+
+  auto dedup = vecvec<location_idx_t, footpath>{};
+  own.resize(static_cast<bitvec_map<location_idx_t>::size_type>(fps.size()));
+  for (auto l = location_idx_t{0U}; l != location_idx_t{fps.size()}; ++l) {
+    auto const a = fps[l];
+    auto const b = base[l];
+    if (std::equal(begin(a), end(a), begin(b), end(b))) {
+      dedup.add_back_sized(0U);
+    } else {
+      own.set(l, true);
+      dedup.emplace_back(a);
+    }
+  }
+
+  auto const n_removed = fps.data_.size() - dedup.data_.size();
+  fps = std::move(dedup);
+  return n_removed;
+}
+
+}  // namespace
+
+void deduplicate_footpath_profiles(timetable& tt) {
+  auto const timer = scoped_timer{"loader.deduplicate_footpath_profiles"};
+
+  auto& loc = tt.locations_;
+  auto n_removed = std::size_t{0U};
+  for (auto p = profile_idx_t{1U}; p != kMaxProfiles; ++p) {
+    n_removed += deduplicate_profile(loc.footpaths_out_,
+                                     loc.has_own_footpaths_out_, p);
+    n_removed +=
+        deduplicate_profile(loc.footpaths_in_, loc.has_own_footpaths_in_, p);
+  }
+
+  log(log_lvl::info, "loader.deduplicate_footpath_profiles",
+      "{} footpaths shared with profile 0", n_removed);
+}
+
 }  // namespace nigiri::loader
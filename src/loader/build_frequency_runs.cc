@@ -0,0 +1,95 @@
+#include "nigiri/loader/build_frequency_runs.h"
+
+#include <vector>
+
+#include "nigiri/logging.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::loader {
+
+namespace {
+
+// Only keep runs of routes with at least this average run length.
+constexpr auto const kMinAvgRunLength = 4U;
+
+// Event `event_idx` (= stop_idx * 2 - (arrival ? 1 : 0)) in minutes.
+int event_time(timetable const& tt,
+               route_idx_t const r,
+               transport_idx_t const t,
+               unsigned const event_idx) {
+  return static_cast<int>(
+      tt.event_mam(r, t, static_cast<stop_idx_t>((event_idx + 1U) / 2U),
+                   event_idx % 2U == 1U ? event_type::kArr : event_type::kDep)
+          .as_duration()
+          .count());
+}
+
+}  // namespace
+
+void build_frequency_runs(timetable& tt) {
+  auto const timer = scoped_timer{"loader.build_frequency_runs"};
+
+  auto route_frequency_runs = vecvec<route_idx_t, frequency_run>{};
+  auto runs = std::vector<frequency_run>{};
+  auto n_routes_with_runs = 0U;
+  auto n_transports_in_runs = std::size_t{0U};
+  for (auto r = route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const transports = tt.route_transport_ranges_[r];
+    auto const n = static_cast<std::uint32_t>(transports.size());
+    auto const n_events =
+        static_cast<unsigned>(tt.route_location_seq_[r].size() * 2U - 2U);
+
+    auto const transport = [&](std::uint32_t const i) {
+      return transport_idx_t{to_idx(transports.from_) + i};
+    };
+    auto const dep = [&](std::uint32_t const i) {
+      return event_time(tt, r, transport(i), 0U);
+    };
+    auto const same_travel_times = [&](std::uint32_t const a,
+                                       std::uint32_t const b) {
+      for (auto k = 1U; k != n_events; ++k) {
+        if (event_time(tt, r, transport(a), k) - dep(a) !=
+            event_time(tt, r, transport(b), k) - dep(b)) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    runs.clear();
+    for (auto from = std::uint32_t{0U}; from != n;) {
+      auto to = from + 1U;
+      auto headway = 1;
+      if (to != n && same_travel_times(from, to)) {
+        headway = dep(to) - dep(from);
+        if (headway > 0 && headway < 1440) {
+          while (to != n && dep(to) - dep(to - 1U) == headway &&
+                 same_travel_times(from, to)) {
+            ++to;
+          }
+        } else {
+          headway = 1;
+        }
+      }
+      runs.push_back({.from_ = from,
+                      .n_ = to - from,
+                      .headway_ = static_cast<std::uint16_t>(headway)});
+      from = to;
+    }
+
+    if (n != 0U && runs.size() * kMinAvgRunLength <= n) {
+      route_frequency_runs.emplace_back(runs);
+      ++n_routes_with_runs;
+      n_transports_in_runs += n;
+    } else {
+      route_frequency_runs.emplace_back(std::vector<frequency_run>{});
+    }
+  }
+  tt.route_frequency_runs_ = std::move(route_frequency_runs);
+
+  log(log_lvl::info, "loader.build_frequency_runs",
+      "{} routes with frequency runs ({} transports)", n_routes_with_runs,
+      n_transports_in_runs);
+}
+
+}  // namespace nigiri::loader
@@ -0,0 +1,52 @@
+#include "nigiri/loader/compress_bitfields.h"
+
+#include "utl/get_or_create.h"
+#include "utl/verify.h"
+
+#include "nigiri/logging.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::loader {
+
+void compress_bitfields(timetable& tt) {
+  auto const timer = scoped_timer{"loader.compress_bitfields"};
+
+  utl::verify(!tt.has_compressed_bitfields(),
+              "compress_bitfields: already compressed");
+
+  auto compressed = compressed_bitfields{};
+  auto bitfield_indices = hash_map<bitfield, bitfield_idx_t>{};
+  auto new_idx = vector_map<bitfield_idx_t, bitfield_idx_t>{};
+  new_idx.resize(tt.bitfields_.size());
+  for (auto i = bitfield_idx_t{0U}; i != tt.bitfields_.size(); ++i) {
+    new_idx[i] = utl::get_or_create(bitfield_indices, tt.bitfields_[i], [&]() {
+      return compressed.add(compressed_bitfield::compress(tt.bitfields_[i]));
+    });
+  }
+
+  auto const remap = [&](bitfield_idx_t& i) {
+    if (i != bitfield_idx_t::invalid()) {
+      i = new_idx[i];
+    }
+  };
+  for (auto& i : tt.transport_traffic_days_) {
+    remap(i);
+  }
+  for (auto& i : tt.trip_service_) {
+    remap(i);
+  }
+  for (auto& r : tt.booking_rules_) {
+    remap(r.bitfield_idx_);
+  }
+
+  auto const before = tt.bitfields_.size() * sizeof(bitfield);
+  auto const after = compressed.size_bytes();
+  log(log_lvl::info, "loader.compress_bitfields",
+      "{} bitfields ({} unique): {} bytes -> {} bytes", tt.bitfields_.size(),
+      compressed.size(), before, after);
+
+  tt.compressed_bitfields_ = std::move(compressed);
+  tt.bitfields_ = vector_map<bitfield_idx_t, bitfield>{};
+}
+
+}  // namespace nigiri::loader
@@ -0,0 +1,89 @@
+#include "nigiri/loader/compress_route_stop_times.h"
+
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "utl/get_or_create.h"
+#include "utl/verify.h"
+
+#include "nigiri/logging.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::loader {
+
+void compress_route_stop_times(timetable& tt) {
+  auto const timer = scoped_timer{"loader.compress_route_stop_times"};
+
+  utl::verify(!tt.has_compressed_stop_times(),
+              "compress_route_stop_times: already compressed");
+
+  auto const n_transports = tt.transport_route_.size();
+  auto first_dep = vector_map<transport_idx_t, delta>{};
+  auto profile_idx = vector_map<transport_idx_t, std::uint16_t>{};
+  auto route_profiles = vector_map<route_idx_t, std::uint32_t>{};
+  auto profiles = vector<std::uint16_t>{};
+  for (auto i = 0U; i != n_transports; ++i) {
+    first_dep.emplace_back(delta{0U, 0U});
+  }
+  profile_idx.resize(n_transports);
+  route_profiles.resize(tt.n_routes());
+
+  auto n_profiles = std::size_t{0U};
+  auto offsets = std::vector<std::uint16_t>{};
+  auto route_profile_indices = std::map<std::vector<std::uint16_t>, unsigned>{};
+  for (auto r = route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const transports = tt.route_transport_ranges_[r];
+    auto const n = static_cast<unsigned>(transports.size());
+    auto const n_events =
+        static_cast<unsigned>(tt.route_location_seq_[r].size() * 2U - 2U);
+    auto const stop_times = tt.route_stop_time_ranges_[r];
+
+    route_profiles[r] = static_cast<std::uint32_t>(profiles.size());
+    route_profile_indices.clear();
+    auto n_route_profiles = 0U;
+    for (auto j = 0U; j != n; ++j) {
+      auto const t = transport_idx_t{to_idx(transports.from_) + j};
+      auto const first = tt.route_stop_times_[stop_times.from_ + j];
+
+      offsets.clear();
+      for (auto k = 0U; k != n_events; ++k) {
+        auto const ev = tt.route_stop_times_[stop_times.from_ + k * n + j];
+        offsets.push_back(
+            static_cast<std::uint16_t>(ev.count() - first.count()));
+      }
+
+      first_dep[t] = first;
+      profile_idx[t] = static_cast<std::uint16_t>(
+          utl::get_or_create(route_profile_indices, offsets, [&]() {
+            auto const idx = n_route_profiles++;
+            utl::verify(idx <= std::numeric_limits<std::uint16_t>::max(),
+                        "compress_route_stop_times: route {} has more than "
+                        "2^16 stop time profiles",
+                        r);
+            profiles.insert(end(profiles), begin(offsets), end(offsets));
+            ++n_profiles;
+            return idx;
+          }));
+    }
+  }
+
+  log(log_lvl::info, "loader.compress_route_stop_times",
+      "{} transports, {} profiles, {} -> {} bytes", n_transports,
+      n_profiles,
+      tt.route_stop_times_.size() * sizeof(delta) +
+          tt.route_stop_time_ranges_.size() * sizeof(interval<std::uint32_t>),
+      n_transports * (sizeof(delta) + sizeof(std::uint16_t)) +
+          route_profiles.size() * sizeof(std::uint32_t) +
+          profiles.size() * sizeof(std::uint16_t));
+
+  tt.compressed_first_dep_ = std::move(first_dep);
+  tt.compressed_profile_idx_ = std::move(profile_idx);
+  tt.compressed_route_profiles_ = std::move(route_profiles);
+  tt.compressed_profiles_ = std::move(profiles);
+  tt.route_stop_times_ = vector<delta>{};
+  tt.route_stop_time_ranges_ =
+      vector_map<route_idx_t, interval<std::uint32_t>>{};
+}
+
+}  // namespace nigiri::loader
@@ -200,6 +200,7 @@ void load_timetable(loader_config const& config,
 
   stop_seq_t stop_seq_cache;
   bitvec bikes_allowed_seq_cache;
+  auto utc_cache = local_to_utc_cache{};
   auto const get_bikes_allowed_seq =
       [&](std::basic_string<gtfs_trip_idx_t> const& trips) -> bitvec const* {
     if (trips.size() == 1U) {
@@ -226,7 +227,7 @@ void load_timetable(loader_config const& config,
                             bitfield const* traffic_days) {
     expand_trip(
         trip_data, noon_offsets, tt, trips, traffic_days, tt.date_range_,
-        assistance, [&](utc_trip&& s) {
+        assistance, utc_cache, [&](utc_trip&& s) {
           auto const* stop_seq = get_stop_seq(trip_data, s, stop_seq_cache);
           auto const clasz = trip_data.get(s.trips_.front()).get_clasz(tt);
           auto const* bikes_allowed_seq = get_bikes_allowed_seq(s.trips_);
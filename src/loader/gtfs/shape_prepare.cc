@@ -1,6 +1,7 @@
 #include "nigiri/loader/gtfs/shape_prepare.h"
 
 #include <algorithm>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <type_traits>
@@ -12,13 +13,13 @@
 #include "geo/polyline.h"
 
 #include "utl/enumerate.h"
-#include "utl/helpers/algorithm.h"
 #include "utl/insert_sorted.h"
 #include "utl/pairwise.h"
 #include "utl/parallel_for.h"
 #include "utl/progress_tracker.h"
 
 #include "nigiri/loader/gtfs/shape.h"
+#include "nigiri/loader/gtfs/shape_segment_index.h"
 #include "nigiri/loader/gtfs/trip.h"
 #include "nigiri/rt/frun.h"
 #include "nigiri/shapes_storage.h"
@@ -27,23 +28,11 @@
 
 namespace nigiri::loader::gtfs {
 
-std::size_t get_closest(geo::latlng const& pos,
-                        std::span<geo::latlng const> shape) {
-  if (shape.size() < 2U) {
-    return 0U;
-  }
-  auto const best = geo::distance_to_polyline(pos, shape);
-  auto const from = shape[best.segment_idx_];
-  auto const to = shape[best.segment_idx_ + 1];
-  return geo::distance(pos, from) <= geo::distance(pos, to)
-             ? best.segment_idx_
-             : best.segment_idx_ + 1;
-}
-
 std::vector<shape_offset_t> get_offsets_by_stops(
     timetable const& tt,
-    std::span<geo::latlng const> shape,
+    shape_segment_index const& index,
     stop_seq_t const& stop_seq) {
+  auto const& shape = index.shape_;
   auto offsets = std::vector<shape_offset_t>(stop_seq.size());
   auto remaining_start = cista::base_t<shape_offset_t>{1U};
   // Reserve space to map each stop to a different point
@@ -57,7 +46,9 @@ std::vector<shape_offset_t> get_offsets_by_stops(
     } else {
       auto const pos = tt.locations_.coordinates_[stop{s}.location_idx()];
       auto const offset =
-          get_closest(pos, shape.subspan(remaining_start, max_width + 1U));
+          index.get_closest(pos, remaining_start,
+                            remaining_start + max_width + 1U) -
+          remaining_start;
       offsets[i] = shape_offset_t{remaining_start + offset};
       remaining_start += offset + 1U;
       max_width -= offset;
@@ -136,6 +127,13 @@ void process_task(timetable const& tt,
                   task& t) {
   auto const shape = shapes_data.get_shape(shape_states.get_shape_idx(i));
   auto const& shape_distances = shape_states.distances_[i];
+  auto index = std::optional<shape_segment_index>{};
+  auto const get_index = [&]() -> shape_segment_index const& {
+    if (!index.has_value()) {
+      index.emplace(shape);
+    }
+    return *index;
+  };
   for (auto& x : t) {
     auto& r = x.result_;
     auto const& [stop_seq, distances] = std::tie(x.stop_seq_, x.dist_traveled_);
@@ -145,7 +143,7 @@ void process_task(timetable const& tt,
                      ? std::vector<shape_offset_t>{}
                  : (!shape_distances.empty() && distances != nullptr)
                      ? get_offsets_by_dist_traveled(*distances, shape_distances)
-                     : get_offsets_by_stops(tt, shape, *stop_seq);
+                     : get_offsets_by_stops(tt, get_index(), *stop_seq);
 
     // Calculate bounding boxes
     if (r.offsets_.empty()) {
@@ -220,8 +218,17 @@ void assign_shape_offsets(shapes_storage& shapes_data,
 
 void assign_bounding_boxes(timetable const& tt,
                            shapes_storage& shapes_data,
-                           vector_map<relative_shape_idx_t, task> const& tasks,
-                           shape_loader_state const& shape_states) {
+                           vector_map<relative_shape_idx_t, task> const& tasks) {
+  // Results by offset index to avoid a linear search per trip.
+  auto results = hash_map<shape_offset_idx_t, stop_seq_dist::result const*>{};
+  for (auto const& task : tasks) {
+    for (auto const& x : task) {
+      if (x.result_.shape_offset_idx_ != shape_offset_idx_t::invalid()) {
+        results.emplace(x.result_.shape_offset_idx_, &x.result_);
+      }
+    }
+  }
+
   auto const new_routes =
       interval{static_cast<route_idx_t>(shapes_data.route_bboxes_.size()),
                static_cast<route_idx_t>(tt.route_transport_ranges_.size())};
@@ -261,15 +268,12 @@ void assign_bounding_boxes(timetable const& tt,
             offset_idx == shape_offset_idx_t::invalid()) {
           return;
         }
-        auto const& task = tasks[shape_states.get_relative_idx(shape_idx)];
-        auto const it = utl::find_if(task, [&](stop_seq_dist const& s) {
-          return s.result_.shape_offset_idx_ == offset_idx;
-        });
-        if (it == end(task)) {
+        auto const it = results.find(offset_idx);
+        if (it == end(results)) {
           return;
         }
 
-        auto const& res = it->result_;
+        auto const& res = *it->second;
         bounding_box.extend(res.trip_bbox_);
         auto const& bboxes = res.segment_bboxes_;
         if (!bboxes.empty()) {
@@ -309,7 +313,7 @@ void calculate_shape_offsets_and_bboxes(
   progress_tracker->status("Writing offsets and bounding boxes")
       .out_bounds(99.F, 100.F);
   assign_shape_offsets(shapes_data, trips, tasks, shape_states);
-  assign_bounding_boxes(tt, shapes_data, tasks, shape_states);
+  assign_bounding_boxes(tt, shapes_data, tasks);
 }
 
 }  // namespace nigiri::loader::gtfs
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "nigiri/loader/gtfs/shape_segment_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+#include "geo/constants.h"
+#include "geo/polyline.h"
+
+namespace nigiri::loader::gtfs {
+
+namespace {
+
+// Absorbs rounding errors of the bound compared to geo::distance.
+constexpr auto const kSlackMeters = 0.01;
+
+using vec3 = std::array<double, 3U>;
+
+double to_rad(double const deg) { return deg * std::numbers::pi / 180.0; }
+
+double to_deg(double const rad) { return rad * 180.0 / std::numbers::pi; }
+
+vec3 to_vec3(geo::latlng const& p) {
+  auto const lat = to_rad(p.lat_);
+  auto const lng = to_rad(p.lng_);
+  return {std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng),
+          std::sin(lat)};
+}
+
+vec3 cross(vec3 const& a, vec3 const& b) {
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+          a[0] * b[1] - a[1] * b[0]};
+}
+
+double dot(vec3 const& a, vec3 const& b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Extends the latitude range of the box by the north- and southernmost
+// point of the great circle arc between from and to.
+void extend_by_arc(geo::box& box,
+                   geo::latlng const& from,
+                   geo::latlng const& to) {
+  auto const a = to_vec3(from);
+  auto const b = to_vec3(to);
+  auto const n = cross(a, b);
+  auto const n_len = std::sqrt(dot(n, n));
+  if (n_len < 1E-12) {
+    return;  // same or antipodal points
+  }
+
+  // The points with the highest/lowest z coordinate on the great circle.
+  auto const nz = n[2] / n_len;
+  auto const north =
+      vec3{-nz * n[0] / n_len, -nz * n[1] / n_len, 1.0 - nz * nz};
+  auto const south = vec3{-north[0], -north[1], -north[2]};
+  auto const on_arc = [&](vec3 const& p) {
+    return dot(cross(a, p), n) >= 0.0 && dot(cross(p, b), n) >= 0.0;
+  };
+
+  auto const extreme_lat = to_deg(std::acos(std::min(1.0, std::abs(nz))));
+  if (on_arc(north)) {
+    box.max_.lat_ = std::max(box.max_.lat_, extreme_lat);
+  }
+  if (on_arc(south)) {
+    box.min_.lat_ = std::min(box.min_.lat_, -extreme_lat);
+  }
+}
+
+}  // namespace
+
+shape_segment_index::shape_segment_index(std::span<geo::latlng const> shape)
+    : shape_{shape} {
+  for (auto from = std::size_t{0U}; from + 1U < shape.size();
+       from += kBlockSize) {
+    auto const to = std::min(from + kBlockSize + 1U, shape.size());
+    auto b = geo::box{};
+    for (auto const& p : shape.subspan(from, to - from)) {
+      b.extend(p);
+    }
+    for (auto i = from; i + 1U < to; ++i) {
+      extend_by_arc(b, shape[i], shape[i + 1U]);
+    }
+    block_bboxes_.emplace_back(b);
+  }
+}
+
+double shape_segment_index::min_distance(geo::latlng const& pos,
+                                         geo::box const& b) {
+  // Smallest longitude difference between pos and any point in the box.
+  auto const lng_diff = [&]() {
+    if (b.max_.lng_ - b.min_.lng_ >= 180.0 ||
+        (b.min_.lng_ <= pos.lng_ && pos.lng_ <= b.max_.lng_)) {
+      return 0.0;
+    }
+    auto const angle = [&](double const lng) {
+      auto const d = std::fmod(std::abs(pos.lng_ - lng), 360.0);
+      return std::min(d, 360.0 - d);
+    };
+    return std::min(angle(b.min_.lng_), angle(b.max_.lng_));
+  }();
+
+  // For any point (lat', lng') in the box:
+  //   cos(d) = sin(lat) sin(lat') + cos(lat) cos(lat') cos(lng - lng')
+  //         <= s sin(lat') + c cos(lat')
+  //          = hypot(s, c) cos(lat' - peak)
+  // The maximum over [min lat, max lat] is at peak or at an interval end.
+  auto const s = std::sin(to_rad(pos.lat_));
+  auto const c = std::cos(to_rad(pos.lat_)) * std::cos(to_rad(lng_diff));
+  auto const peak = std::atan2(s, c);
+  auto const lat_min = to_rad(b.min_.lat_);
+  auto const lat_max = to_rad(b.max_.lat_);
+  auto const max_cos =
+      (lat_min <= peak && peak <= lat_max)
+          ? std::hypot(s, c)
+          : std::max(s * std::sin(lat_min) + c * std::cos(lat_min),
+                     s * std::sin(lat_max) + c * std::cos(lat_max));
+  auto const d =
+      geo::kEarthRadiusMeters * std::acos(std::clamp(max_cos, -1.0, 1.0));
+  return std::max(0.0, d * (1.0 - 1E-9) - kSlackMeters);
+}
+
+std::size_t shape_segment_index::get_closest(geo::latlng const& pos,
+                                             std::size_t const from,
+                                             std::size_t const to) const {
+  if (to - from < 2U) {
+    return from;
+  }
+
+  auto const last_segment = to - 2U;
+  auto best_dist = std::numeric_limits<double>::max();
+  auto best_segment = from;
+  for (auto block = from / kBlockSize; block * kBlockSize <= last_segment;
+       ++block) {
+    if (min_distance(pos, block_bboxes_[block]) >= best_dist) {
+      continue;
+    }
+    auto const seg_from = std::max(from, block * kBlockSize);
+    auto const seg_to = std::min(last_segment, (block + 1U) * kBlockSize - 1U);
+    auto const candidate = geo::distance_to_polyline(
+        pos, shape_.subspan(seg_from, seg_to - seg_from + 2U));
+    if (candidate.distance_to_polyline_ < best_dist) {
+      best_dist = candidate.distance_to_polyline_;
+      best_segment = seg_from + candidate.segment_idx_;
+    }
+  }
+
+  return geo::distance(pos, shape_[best_segment]) <=
+                 geo::distance(pos, shape_[best_segment + 1U])
+             ? best_segment
+             : best_segment + 1U;
+}
+
+}  // namespace nigiri::loader::gtfs
@@ -3,7 +3,11 @@
 #include <execution>
 
 #include "nigiri/loader/build_footpaths.h"
+#include "nigiri/loader/build_frequency_runs.h"
 #include "nigiri/loader/build_lb_graph.h"
+#include "nigiri/loader/compress_bitfields.h"
+#include "nigiri/loader/compress_route_stop_times.h"
+#include "nigiri/loader/reorder_routes.h"
 #include "nigiri/special_stations.h"
 #include "nigiri/timetable.h"
 
@@ -26,7 +30,9 @@ void register_special_stations(timetable& tt) {
   tt.bitfields_.emplace_back(bitfield{});  // bitfield_idx 0 = 000...00 bitfield
 }
 
-void finalize(timetable& tt, finalize_options const opt) {
+void finalize(timetable& tt,
+              finalize_options const opt,
+              shapes_storage* shapes) {
   tt.location_routes_.resize(tt.n_locations());
 
   {
@@ -44,9 +50,33 @@ void finalize(timetable& tt, finalize_options const opt) {
                             tt.trip_id_strings_[b.first].view());
         });
   }
+  tt.build_trip_id_index();
+  {
+    auto const timer = scoped_timer{"loader.compact_strings"};
+    tt.locations_.names_.compact();
+    tt.trip_id_strings_.compact();
+    tt.trip_display_names_.compact();
+    tt.trip_direction_strings_.compact();
+  }
   build_footpaths(tt, opt);
+  if (opt.reorder_locations_) {
+    reorder_locations(tt);
+  }
+  if (opt.reorder_routes_) {
+    reorder_routes(tt, shapes);
+  }
   build_lb_graph<direction::kForward>(tt);
   build_lb_graph<direction::kBackward>(tt);
+  if (opt.build_frequency_runs_) {
+    build_frequency_runs(tt);
+  }
+  if (opt.compress_route_stop_times_) {
+    compress_route_stop_times(tt);
+  }
+  if (opt.compress_bitfields_) {
+    compress_bitfields(tt);
+  }
+  tt.renew_id();
 }
 
 void finalize(timetable& tt,
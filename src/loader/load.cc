@@ -61,7 +61,7 @@ timetable load(std::vector<std::pair<std::string, loader_config>> const& paths,
     }
   }
 
-  finalize(tt, finalize_opt);
+  finalize(tt, finalize_opt, shapes);
 
   return tt;
 }
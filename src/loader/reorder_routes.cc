@@ -0,0 +1,393 @@
+#include "nigiri/loader/reorder_routes.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "utl/overloaded.h"
+#include "utl/verify.h"
+
+#include "geo/box.h"
+
+#include "nigiri/logging.h"
+#include "nigiri/shapes_storage.h"
+#include "nigiri/special_stations.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::loader {
+
+namespace {
+
+constexpr auto const kHilbertOrder = 16U;
+constexpr auto const kHilbertN = 1U << kHilbertOrder;
+
+std::uint64_t hilbert_idx(std::uint32_t x, std::uint32_t y) {
+  auto d = std::uint64_t{0U};
+  for (auto s = kHilbertN / 2U; s > 0U; s /= 2U) {
+    auto const rx = (x & s) != 0U ? 1U : 0U;
+    auto const ry = (y & s) != 0U ? 1U : 0U;
+    d += static_cast<std::uint64_t>(s) * s * ((3U * rx) ^ ry);
+    if (ry == 0U) {
+      if (rx == 1U) {
+        x = kHilbertN - 1U - x;
+        y = kHilbertN - 1U - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+std::uint32_t to_grid(double const v, double const min, double const max) {
+  auto const rel = std::clamp((v - min) / (max - min), 0.0, 1.0);
+  return std::min(static_cast<std::uint32_t>(rel * kHilbertN), kHilbertN - 1U);
+}
+
+std::uint64_t location_key(geo::latlng const& pos) {
+  return hilbert_idx(to_grid(pos.lng_, -180.0, 180.0),
+                     to_grid(pos.lat_, -90.0, 90.0));
+}
+
+std::uint64_t route_key(timetable const& tt, route_idx_t const r) {
+  auto lat = 0.0;
+  auto lng = 0.0;
+  auto const seq = tt.route_location_seq_[r];
+  for (auto const s : seq) {
+    auto const pos = tt.locations_.coordinates_[stop{s}.location_idx()];
+    lat += pos.lat_;
+    lng += pos.lng_;
+  }
+  auto const n = static_cast<double>(seq.size());
+  return location_key({lat / n, lng / n});
+}
+
+using location_map = vector_map<location_idx_t, location_idx_t>;
+
+template <typename T>
+vector_map<location_idx_t, T> permute(vector_map<location_idx_t, T> const& v,
+                                      location_map const& new_to_old) {
+  auto ret = vector_map<location_idx_t, T>{};
+  ret.reserve(v.size());
+  for (auto const old : new_to_old) {
+    ret.emplace_back(v[old]);
+  }
+  return ret;
+}
+
+bitvec_map<location_idx_t> permute(bitvec_map<location_idx_t> const& v,
+                                   location_map const& new_to_old) {
+  auto ret = bitvec_map<location_idx_t>{};
+  if (v.size() == 0U) {
+    return ret;
+  }
+  auto const n = static_cast<location_idx_t::value_t>(new_to_old.size());
+  ret.resize(n);
+  for (auto l = location_idx_t{0U}; l != n; ++l) {
+    ret.set(l, v.test(new_to_old[l]));
+  }
+  return ret;
+}
+
+template <typename T, typename Fn>
+vecvec<location_idx_t, T> permute(vecvec<location_idx_t, T> const& v,
+                                  location_map const& new_to_old,
+                                  Fn&& map) {
+  auto ret = vecvec<location_idx_t, T>{};
+  if (v.size() == 0U) {
+    return ret;
+  }
+  auto bucket = std::vector<T>{};
+  for (auto const old : new_to_old) {
+    bucket.clear();
+    for (auto const& x : v[old]) {
+      bucket.emplace_back(map(x));
+    }
+    ret.emplace_back(bucket);
+  }
+  return ret;
+}
+
+template <typename T, typename Fn>
+mutable_fws_multimap<location_idx_t, T> permute(
+    mutable_fws_multimap<location_idx_t, T> const& v,
+    location_map const& new_to_old,
+    Fn&& map) {
+  auto ret = mutable_fws_multimap<location_idx_t, T>{};
+  if (v.size() == 0U) {
+    return ret;
+  }
+  auto const n = static_cast<location_idx_t::value_t>(new_to_old.size());
+  for (auto l = location_idx_t{0U}; l != n; ++l) {
+    ret.emplace_back();
+    for (auto const& x : v[new_to_old[l]]) {
+      ret[l].emplace_back(map(x));
+    }
+  }
+  return ret;
+}
+
+// Shapes only cover the routes [0, route_bboxes_.size()[ (e.g. routes of
+// sources loaded without shapes come later). Routes beyond that range are
+// skipped. If they end up between covered routes, they get the bounding box
+// of their stops and no segment boxes (as routes without a shape).
+void reorder_shapes(timetable const& tt,
+                    shapes_storage& shapes,
+                    vector_map<route_idx_t, route_idx_t> const& new_to_old) {
+  auto const n_covered = shapes.route_bboxes_.size();
+  if (n_covered == 0U) {
+    return;
+  }
+
+  auto n_new = std::size_t{0U};
+  for (auto r = 0U; r != new_to_old.size(); ++r) {
+    if (to_idx(new_to_old[route_idx_t{r}]) < n_covered) {
+      n_new = r + 1U;
+    }
+  }
+
+  auto bboxes = std::vector<geo::box>{};
+  auto segment_bboxes = std::vector<std::vector<geo::box>>{};
+  for (auto r = 0U; r != n_new; ++r) {
+    auto const old = new_to_old[route_idx_t{r}];
+    if (to_idx(old) < n_covered) {
+      bboxes.emplace_back(shapes.route_bboxes_[old]);
+      auto const segments = shapes.route_segment_bboxes_[old];
+      segment_bboxes.emplace_back(segments.begin(), segments.end());
+    } else {
+      auto b = geo::box{};
+      for (auto const s : tt.route_location_seq_[route_idx_t{r}]) {
+        b.extend(tt.locations_.coordinates_[stop{s}.location_idx()]);
+      }
+      bboxes.emplace_back(b);
+      segment_bboxes.emplace_back();
+    }
+  }
+
+  shapes.route_bboxes_.clear();
+  shapes.route_segment_bboxes_.clear();
+  for (auto i = 0U; i != bboxes.size(); ++i) {
+    shapes.route_bboxes_.emplace_back(bboxes[i]);
+    shapes.route_segment_bboxes_.emplace_back(segment_bboxes[i]);
+  }
+}
+
+}  // namespace
+
+location_map reorder_locations(timetable& tt) {
+  auto const timer = scoped_timer{"loader.reorder_locations"};
+
+  auto const n_locations = tt.n_locations();
+  auto const n_special = static_cast<location_idx_t::value_t>(
+      special_station::kSpecialStationsSize);
+
+  auto keys = vector_map<location_idx_t, std::uint64_t>{};
+  keys.resize(n_locations);
+  for (auto l = location_idx_t{0U}; l != n_locations; ++l) {
+    keys[l] = location_key(tt.locations_.coordinates_[l]);
+  }
+
+  auto new_to_old = location_map{};
+  new_to_old.resize(n_locations);
+  std::iota(begin(new_to_old), end(new_to_old), location_idx_t{0U});
+  if (n_locations > n_special) {
+    std::stable_sort(std::next(begin(new_to_old), n_special), end(new_to_old),
+                     [&](location_idx_t const a, location_idx_t const b) {
+                       return keys[a] < keys[b];
+                     });
+  }
+
+  auto old_to_new = location_map{};
+  old_to_new.resize(n_locations);
+  for (auto l = location_idx_t{0U}; l != n_locations; ++l) {
+    old_to_new[new_to_old[l]] = l;
+  }
+
+  auto const map_location = [&](location_idx_t const l) {
+    return l == location_idx_t::invalid() ? l : old_to_new[l];
+  };
+  auto const map_footpath = [&](footpath const fp) {
+    return footpath{old_to_new[fp.target()], fp.duration()};
+  };
+  auto const map_td_footpath = [&](td_footpath fp) {
+    fp.target_ = old_to_new[fp.target_];
+    return fp;
+  };
+
+  // Location-indexed data.
+  auto& loc = tt.locations_;
+  for (auto& [id, l] : loc.location_id_to_idx_) {
+    l = old_to_new[l];
+  }
+  loc.names_.idx_ = permute(loc.names_.idx_, new_to_old);
+  {
+    auto ids = vecvec<location_idx_t, char>{};
+    for (auto const old : new_to_old) {
+      ids.emplace_back(loc.ids_[old]);
+    }
+    loc.ids_ = std::move(ids);
+  }
+  loc.coordinates_ = permute(loc.coordinates_, new_to_old);
+  loc.src_ = permute(loc.src_, new_to_old);
+  loc.transfer_time_ = permute(loc.transfer_time_, new_to_old);
+  loc.types_ = permute(loc.types_, new_to_old);
+  loc.location_timezones_ = permute(loc.location_timezones_, new_to_old);
+  loc.parents_ = permute(loc.parents_, new_to_old);
+  for (auto& p : loc.parents_) {
+    p = map_location(p);
+  }
+  loc.equivalences_ = permute(loc.equivalences_, new_to_old, map_location);
+  loc.children_ = permute(loc.children_, new_to_old, map_location);
+  loc.preprocessing_footpaths_out_ =
+      permute(loc.preprocessing_footpaths_out_, new_to_old, map_footpath);
+  loc.preprocessing_footpaths_in_ =
+      permute(loc.preprocessing_footpaths_in_, new_to_old, map_footpath);
+  for (auto p = profile_idx_t{0U}; p != kMaxProfiles; ++p) {
+    loc.footpaths_out_[p] =
+        permute(loc.footpaths_out_[p], new_to_old, map_footpath);
+    loc.footpaths_in_[p] =
+        permute(loc.footpaths_in_[p], new_to_old, map_footpath);
+    loc.has_own_footpaths_out_[p] =
+        permute(loc.has_own_footpaths_out_[p], new_to_old);
+    loc.has_own_footpaths_in_[p] =
+        permute(loc.has_own_footpaths_in_[p], new_to_old);
+    loc.has_td_footpaths_out_[p] =
+        permute(loc.has_td_footpaths_out_[p], new_to_old);
+    loc.has_td_footpaths_in_[p] =
+        permute(loc.has_td_footpaths_in_[p], new_to_old);
+    loc.td_footpaths_out_[p] =
+        permute(loc.td_footpaths_out_[p], new_to_old, map_td_footpath);
+    loc.td_footpaths_in_[p] =
+        permute(loc.td_footpaths_in_[p], new_to_old, map_td_footpath);
+  }
+
+  auto const keep = [](route_idx_t const r) { return r; };
+  tt.location_routes_ = permute(tt.location_routes_, new_to_old, keep);
+  tt.fwd_search_lb_graph_ =
+      permute(tt.fwd_search_lb_graph_, new_to_old, map_footpath);
+  tt.bwd_search_lb_graph_ =
+      permute(tt.bwd_search_lb_graph_, new_to_old, map_footpath);
+
+  // References to locations.
+  for (auto& s : tt.route_location_seq_.data_) {
+    auto const x = stop{s};
+    s = stop{old_to_new[x.location_idx()], x.in_allowed(), x.out_allowed(),
+             x.in_allowed_wheelchair(), x.out_allowed_wheelchair()}
+            .value();
+  }
+  for (auto& d : tt.trip_directions_) {
+    d.apply(utl::overloaded{
+        [&](location_idx_t& l) { l = old_to_new[l]; },
+        [](trip_direction_string_idx_t&) {}});
+  }
+  for (auto& l : tt.area_idx_to_location_idxs_.data_) {
+    l = old_to_new[l];
+  }
+  for (auto& l : tt.geometry_locations_within_.data_) {
+    l = old_to_new[l];
+  }
+
+  return old_to_new;
+}
+
+void reorder_routes(timetable& tt, shapes_storage* shapes) {
+  auto const timer = scoped_timer{"loader.reorder_routes"};
+
+  utl::verify(!tt.has_compressed_stop_times(),
+              "reorder_routes: stop times are compressed");
+
+  auto const n_routes = tt.n_routes();
+
+  auto keys = vector_map<route_idx_t, std::uint64_t>{};
+  keys.resize(n_routes);
+  for (auto r = route_idx_t{0U}; r != n_routes; ++r) {
+    keys[r] = route_key(tt, r);
+  }
+
+  auto new_to_old = vector_map<route_idx_t, route_idx_t>{};
+  new_to_old.resize(n_routes);
+  std::iota(begin(new_to_old), end(new_to_old), route_idx_t{0U});
+  std::stable_sort(begin(new_to_old), end(new_to_old),
+                   [&](route_idx_t const a, route_idx_t const b) {
+                     return keys[a] < keys[b];
+                   });
+
+  auto old_to_new = vector_map<route_idx_t, route_idx_t>{};
+  old_to_new.resize(n_routes);
+  for (auto r = route_idx_t{0U}; r != n_routes; ++r) {
+    old_to_new[new_to_old[r]] = r;
+  }
+
+  // Route-indexed data.
+  auto transport_ranges = vector_map<route_idx_t, interval<transport_idx_t>>{};
+  auto location_seq = vecvec<route_idx_t, stop::value_type>{};
+  auto route_clasz = vector_map<route_idx_t, clasz>{};
+  auto section_clasz = vecvec<route_idx_t, clasz>{};
+  auto bikes_allowed = bitvec{};
+  auto bikes_allowed_per_section = vecvec<route_idx_t, bool>{};
+  auto stop_time_ranges = vector_map<route_idx_t, interval<std::uint32_t>>{};
+  auto stop_times = vector<delta>{};
+
+  bikes_allowed.resize(n_routes * 2U);
+  stop_times.reserve(tt.route_stop_times_.size());
+  for (auto r = route_idx_t{0U}; r != n_routes; ++r) {
+    auto const old = new_to_old[r];
+    transport_ranges.emplace_back(tt.route_transport_ranges_[old]);
+    location_seq.emplace_back(tt.route_location_seq_[old]);
+    route_clasz.emplace_back(tt.route_clasz_[old]);
+    section_clasz.emplace_back(tt.route_section_clasz_[old]);
+    bikes_allowed.set(to_idx(r) * 2U,
+                      tt.route_bikes_allowed_.test(to_idx(old) * 2U));
+    bikes_allowed.set(to_idx(r) * 2U + 1U,
+                      tt.route_bikes_allowed_.test(to_idx(old) * 2U + 1U));
+    bikes_allowed_per_section.emplace_back(
+        tt.route_bikes_allowed_per_section_[old]);
+
+    auto const old_range = tt.route_stop_time_ranges_[old];
+    auto const from = static_cast<std::uint32_t>(stop_times.size());
+    for (auto i = old_range.from_; i != old_range.to_; ++i) {
+      stop_times.push_back(tt.route_stop_times_[i]);
+    }
+    stop_time_ranges.push_back(interval<std::uint32_t>{
+        from, static_cast<std::uint32_t>(stop_times.size())});
+  }
+
+  tt.route_transport_ranges_ = std::move(transport_ranges);
+  tt.route_location_seq_ = std::move(location_seq);
+  tt.route_clasz_ = std::move(route_clasz);
+  tt.route_section_clasz_ = std::move(section_clasz);
+  tt.route_bikes_allowed_ = std::move(bikes_allowed);
+  tt.route_bikes_allowed_per_section_ = std::move(bikes_allowed_per_section);
+  tt.route_stop_time_ranges_ = std::move(stop_time_ranges);
+  tt.route_stop_times_ = std::move(stop_times);
+
+  if (tt.route_frequency_runs_.size() == n_routes) {
+    auto frequency_runs = vecvec<route_idx_t, frequency_run>{};
+    for (auto const old : new_to_old) {
+      frequency_runs.emplace_back(tt.route_frequency_runs_[old]);
+    }
+    tt.route_frequency_runs_ = std::move(frequency_runs);
+  }
+
+  // References to routes.
+  for (auto& r : tt.transport_route_) {
+    r = old_to_new[r];
+  }
+
+  auto location_routes = vecvec<location_idx_t, route_idx_t>{};
+  auto routes = std::vector<route_idx_t>{};
+  for (auto const l_routes : tt.location_routes_) {
+    routes.clear();
+    for (auto const r : l_routes) {
+      routes.emplace_back(old_to_new[r]);
+    }
+    std::sort(begin(routes), end(routes));
+    location_routes.emplace_back(routes);
+  }
+  tt.location_routes_ = std::move(location_routes);
+
+  if (shapes != nullptr) {
+    reorder_shapes(tt, *shapes, new_to_old);
+  }
+}
+
+}  // namespace nigiri::loader
@@ -1,10 +1,73 @@
 #include "nigiri/logging.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string_view>
+
 namespace nigiri {
 
+namespace {
+
+struct stage_report {
+  std::atomic_bool enabled_{false};
+  std::mutex mutex_;
+  std::vector<stage_stats> stages_;
+
+  // Running timers that track their own peak RSS. Every reset of the peak
+  // RSS first folds the current peak into all of them (and the process peak).
+  std::vector<scoped_timer*> open_;
+  std::atomic_size_t process_peak_rss_{0U};
+};
+
+stage_report& get_report() {
+  static auto report = stage_report{};
+  return report;
+}
+
+std::size_t get_process_peak_rss() {
+  return std::max(get_report().process_peak_rss_.load(),
+                  get_memory_usage().peak_rss_);
+}
+
+double to_mb(std::size_t const bytes) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void write_json_string(std::ostream& out, std::string_view s) {
+  out << '"';
+  for (auto const c : s) {
+    switch (c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      default: out << c;
+    }
+  }
+  out << '"';
+}
+
+}  // namespace
+
 scoped_timer::scoped_timer(std::string name)
     : name_{std::move(name)}, start_{std::chrono::steady_clock::now()} {
   log(log_lvl::info, name_.c_str(), "starting {}", std::string_view{name_});
+
+  auto& report = get_report();
+  if (report.enabled_) {
+    reported_ = true;
+    mem_start_ = get_memory_usage();
+    auto const lock = std::scoped_lock{report.mutex_};
+    auto const peak = get_process_peak_rss();
+    report.process_peak_rss_ = peak;
+    for (auto* const t : report.open_) {
+      t->stage_peak_rss_ = std::max(t->stage_peak_rss_, peak);
+    }
+    tracks_stage_peak_ = reset_peak_rss();
+    if (tracks_stage_peak_) {
+      report.open_.push_back(this);
+    }
+  }
 }
 
 scoped_timer::~scoped_timer() {
@@ -13,8 +76,66 @@ scoped_timer::~scoped_timer() {
   auto const t =
       static_cast<double>(duration_cast<microseconds>(stop - start_).count()) /
       1000.0;
-  log(log_lvl::info, name_.c_str(), "finished {} {}ms", std::string_view{name_},
-      t);
+
+  if (!reported_) {
+    log(log_lvl::info, name_.c_str(), "finished {} {}ms",
+        std::string_view{name_}, t);
+    return;
+  }
+
+  auto const mem_stop = get_memory_usage();
+  auto const peak = tracks_stage_peak_
+                        ? std::max(stage_peak_rss_, mem_stop.peak_rss_)
+                        : get_process_peak_rss();
+  log(log_lvl::info, name_.c_str(),
+      "finished {} {}ms [rss={:.1f}MB, {}={:.1f}MB, allocations={}]",
+      std::string_view{name_}, t, to_mb(mem_stop.current_rss_),
+      tracks_stage_peak_ ? "stage_peak_rss" : "process_peak_rss", to_mb(peak),
+      mem_stop.n_allocations_ - mem_start_.n_allocations_);
+
+  auto& report = get_report();
+  auto const lock = std::scoped_lock{report.mutex_};
+  std::erase(report.open_, this);
+  report.stages_.push_back(stage_stats{.name_ = name_,
+                                       .duration_ms_ = t,
+                                       .begin_ = mem_start_,
+                                       .end_ = mem_stop,
+                                       .peak_rss_ = peak,
+                                       .stage_peak_ = tracks_stage_peak_});
+}
+
+void enable_stage_report() { get_report().enabled_ = true; }
+
+std::vector<stage_stats> get_stage_report() {
+  auto& report = get_report();
+  auto const lock = std::scoped_lock{report.mutex_};
+  return report.stages_;
+}
+
+void write_stage_report(std::ostream& out) {
+  auto const stages = get_stage_report();
+  out << "{\n  \"stages\": [";
+  auto first = true;
+  for (auto const& s : stages) {
+    out << (first ? "\n" : ",\n") << "    {\"name\": ";
+    write_json_string(out, s.name_);
+    out << fmt::format(
+        ", \"duration_ms\": {:.3f}, \"rss_begin\": {}, \"rss_end\": {}, "
+        "\"{}\": {}, \"allocations\": {}, \"allocated_bytes\": {}}}",
+        s.duration_ms_, s.begin_.current_rss_, s.end_.current_rss_,
+        s.stage_peak_ ? "stage_peak_rss" : "process_peak_rss", s.peak_rss_,
+        s.end_.n_allocations_ - s.begin_.n_allocations_,
+        s.end_.allocated_bytes_ - s.begin_.allocated_bytes_);
+    first = false;
+  }
+  auto const total = get_memory_usage();
+  out << "\n  ],\n"
+      << fmt::format(
+             "  \"total\": {{\"rss\": {}, \"process_peak_rss\": {}, "
+             "\"allocations\": {}, \"allocated_bytes\": {}}}\n",
+             total.current_rss_, get_process_peak_rss(), total.n_allocations_,
+             total.allocated_bytes_)
+      << "}\n";
 }
 
 }  // namespace nigiri
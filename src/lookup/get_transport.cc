@@ -18,13 +18,7 @@ void for_each_schedule_transport(timetable const& tt,
            tt.trip_id_strings_[t_id_idx].view() == id.id_;
   };
 
-  auto const lb = std::lower_bound(
-      begin(tt.trip_id_to_idx_), end(tt.trip_id_to_idx_), id,
-      [&](pair<trip_id_idx_t, trip_idx_t> const& a, trip_id const& b) {
-        return std::tuple(tt.trip_id_src_[a.first],
-                          tt.trip_id_strings_[a.first].view()) <
-               std::tuple(b.src_, std::string_view{b.id_});
-      });
+  auto const lb = tt.find_trip_id(id.src_, id.id_);
 
   // One trip can have several transports associated to it. Reasons:
   //  - local to UTC time conversion results in different time strings, the
@@ -48,16 +42,17 @@ void for_each_schedule_transport(timetable const& tt,
           (first_dep.as_duration() + tz_offset).count() / 1440;
       auto const t_day =
           tt.day_idx(date::sys_days{day} - day_offset * date::days{1});
-      auto const& traffic_days = tt.bitfields_[tt.transport_traffic_days_[t]];
+      auto const bf = tt.transport_traffic_days_[t];
+      auto const active = tt.is_traffic_day(bf, to_idx(t_day));
 
       std::cout << tt.trip_id_strings_[i->first].view()
                 << "first_dep=" << first_dep << ", day_offset=" << day_offset
                 << ", day=" << tt.to_unixtime(t_day, 0_minutes)
-                << ", active=" << traffic_days.test(to_idx(t_day))
-                << ", traffic_days="
-                << day_list{traffic_days, tt.internal_interval_days().from_}
+                << ", active=" << active << ", traffic_days="
+                << day_list{tt.traffic_days(bf),
+                            tt.internal_interval_days().from_}
                 << "\n";
-      if (traffic_days.test(to_idx(t_day))) {
+      if (active) {
         std::forward<Fn>(cb)(transport{t, t_day}, interval);
       }
     }
@@ -0,0 +1,105 @@
+#include "nigiri/mapped_timetable.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "cista/serialization.h"
+
+#include "utl/verify.h"
+
+#include "nigiri/logging.h"
+
+namespace nigiri {
+
+namespace {
+
+constexpr auto const kMode = cista::mode::WITH_INTEGRITY;
+
+}  // namespace
+
+mapped_timetable::mapped_timetable(std::filesystem::path const& p,
+                                   timetable_read_options const& opt) {
+  auto const timer = scoped_timer{"timetable.map"};
+
+  utl::verify(!opt.date_window_.has_value(),
+              "timetable.map: date window requires timetable::read");
+
+#if defined(_WIN32)
+  fallback_.emplace(timetable::read(p, opt));
+  tt_ = fallback_->get();
+#else
+  if (opt.huge_pages_) {
+    log(log_lvl::info, "timetable.map", "huge pages ignored for mapped file");
+  }
+
+  auto const fd = ::open(p.c_str(), O_RDONLY);
+  utl::verify(fd != -1, "timetable.map: cannot open {}: {}", p,
+              std::strerror(errno));
+  size_ = std::filesystem::file_size(p);
+  auto const addr =
+      ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  auto const mmap_errno = errno;
+  ::close(fd);
+  utl::verify(addr != MAP_FAILED, "timetable.map: cannot map {}: {}", p,
+              std::strerror(mmap_errno));
+  addr_ = addr;
+
+  try {
+    auto const begin = static_cast<std::uint8_t*>(addr_);
+    tt_ = cista::deserialize<timetable, kMode>(begin, begin + size_);
+    tt_->locations_.resolve_timezones();
+
+    // No more writes: keeps all untouched pages shared with the page cache
+    // (also for mlock, which would copy writable private pages).
+    utl::verify(::mprotect(addr_, size_, PROT_READ) == 0,
+                "timetable.map: mprotect failed: {}", std::strerror(errno));
+  } catch (...) {
+    reset();
+    throw;
+  }
+
+  tt_->advise_routing_data(opt);
+#endif
+}
+
+mapped_timetable::~mapped_timetable() { reset(); }
+
+mapped_timetable::mapped_timetable(mapped_timetable&& o) noexcept
+    : addr_{std::exchange(o.addr_, nullptr)},
+      size_{std::exchange(o.size_, 0U)},
+      tt_{std::exchange(o.tt_, nullptr)},
+      fallback_{std::move(o.fallback_)} {}
+
+mapped_timetable& mapped_timetable::operator=(mapped_timetable&& o) noexcept {
+  if (this != &o) {
+    reset();
+    addr_ = std::exchange(o.addr_, nullptr);
+    size_ = std::exchange(o.size_, 0U);
+    tt_ = std::exchange(o.tt_, nullptr);
+    fallback_ = std::move(o.fallback_);
+    o.fallback_.reset();
+  }
+  return *this;
+}
+
+void mapped_timetable::reset() {
+#if !defined(_WIN32)
+  if (addr_ != nullptr) {
+    ::munmap(addr_, size_);
+  }
+#endif
+  addr_ = nullptr;
+  size_ = 0U;
+  tt_ = nullptr;
+  fallback_.reset();
+}
+
+}  // namespace nigiri
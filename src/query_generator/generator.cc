@@ -317,8 +317,10 @@ std::optional<day_idx_t> generator::random_active_day(
     nigiri::transport_idx_t const tr_idx) {
   auto const random_day = [&]() { return day_idx_t{day_d_(rng_)}; };
 
-  auto const& bf = tt_.bitfields_[tt_.transport_traffic_days_[tr_idx]];
-  auto const is_active = [&bf](day_idx_t const d) { return bf.test(d.v_); };
+  auto const bf = tt_.transport_traffic_days_[tr_idx];
+  auto const is_active = [&](day_idx_t const d) {
+    return tt_.is_traffic_day(bf, d.v_);
+  };
 
   // try randomize
   for (auto i = 0U; i < 10; ++i) {
@@ -372,10 +374,10 @@ std::optional<interval<unixtime_t>> generator::get_start_interval(
 bool generator::arr_in_itv(transport_idx_t const tpt_idx,
                            stop_idx_t const stp_idx,
                            interval<unixtime_t> const& itv) const {
-  auto const& bf = tt_.bitfields_[tt_.transport_traffic_days_[tpt_idx]];
+  auto const bf = tt_.transport_traffic_days_[tpt_idx];
   for (auto day_idx = day_idx_t{kTimetableOffset.count()};
        day_idx != tt_n_days(); ++day_idx) {
-    if (bf.test(day_idx.v_)) {
+    if (tt_.is_traffic_day(bf, day_idx.v_)) {
       if (itv.contains(
               tt_.event_time({tpt_idx, day_idx}, stp_idx, event_type::kArr))) {
         return true;
@@ -0,0 +1,157 @@
+#include "nigiri/routing/batch_search.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <numeric>
+
+#include "cista/hash.h"
+
+#include "utl/helpers/algorithm.h"
+#include "utl/parallel_for.h"
+
+#include "nigiri/routing/raptor_search.h"
+
+namespace nigiri::routing {
+
+namespace {
+
+bool same_destination(query const& a, query const& b) {
+  return a.destination_ == b.destination_ &&
+         a.dest_match_mode_ == b.dest_match_mode_ && a.td_dest_ == b.td_dest_ &&
+         a.via_stops_ == b.via_stops_ &&
+         a.max_travel_time_ == b.max_travel_time_;
+}
+
+// Equal for queries with same_destination() == true.
+std::uint64_t destination_hash(query const& q) {
+  auto h = cista::hash_combine(
+      cista::BASE_HASH, static_cast<std::uint64_t>(q.dest_match_mode_),
+      static_cast<std::uint64_t>(q.max_travel_time_.count()));
+  for (auto const& o : q.destination_) {
+    h = cista::hash_combine(h, to_idx(o.target()),
+                            static_cast<std::uint64_t>(o.duration().count()),
+                            static_cast<std::uint64_t>(o.type()));
+  }
+  for (auto const& v : q.via_stops_) {
+    h = cista::hash_combine(h, to_idx(v.location_),
+                            static_cast<std::uint64_t>(v.stay_.count()));
+  }
+
+  // Sum: independent of the hash map's iteration order.
+  auto td_h = std::uint64_t{0U};
+  for (auto const& [l, offsets] : q.td_dest_) {
+    auto x = cista::hash_combine(cista::BASE_HASH, to_idx(l));
+    for (auto const& o : offsets) {
+      auto const valid_from = o.valid_from_.time_since_epoch().count();
+      x = cista::hash_combine(x, static_cast<std::uint64_t>(valid_from),
+                              static_cast<std::uint64_t>(o.duration_.count()),
+                              static_cast<std::uint64_t>(o.transport_mode_id_));
+    }
+    td_h += x;
+  }
+  return cista::hash_combine(h, td_h);
+}
+
+struct worker_state {
+  search_state s_state_;
+  raptor_state r_state_;
+  std::size_t group_{std::numeric_limits<std::size_t>::max()};
+};
+
+// Hands the group's prepared destinations to the next search. Resets the
+// flag afterwards, also if the search throws before consuming it. After an
+// exception, the worker's copy of the group state is not trusted anymore.
+struct prepared_destinations_guard {
+  explicit prepared_destinations_guard(worker_state& w)
+      : w_{w}, n_exceptions_{std::uncaught_exceptions()} {
+    w_.s_state_.destinations_prepared_ = true;
+  }
+
+  prepared_destinations_guard(prepared_destinations_guard const&) = delete;
+  prepared_destinations_guard& operator=(prepared_destinations_guard const&) =
+      delete;
+
+  ~prepared_destinations_guard() {
+    w_.s_state_.destinations_prepared_ = false;
+    if (std::uncaught_exceptions() > n_exceptions_) {
+      w_.group_ = std::numeric_limits<std::size_t>::max();
+    }
+  }
+
+  worker_state& w_;
+  int n_exceptions_;
+};
+
+}  // namespace
+
+std::vector<batch_result> raptor_batch_search(timetable const& tt,
+                                              rt_timetable const* rtt,
+                                              std::vector<query> queries,
+                                              direction const search_dir) {
+  for (auto& q : queries) {
+    q.sanitize(tt);
+    utl::sort(q.destination_);
+  }
+
+  // Group queries by destination.
+  auto query_group = std::vector<std::size_t>(queries.size());
+  auto group_query = std::vector<std::size_t>{};
+  auto hash_groups = hash_map<std::uint64_t, std::vector<std::size_t>>{};
+  for (auto i = 0U; i != queries.size(); ++i) {
+    auto& candidates = hash_groups[destination_hash(queries[i])];
+    auto const it = utl::find_if(candidates, [&](std::size_t const g) {
+      return same_destination(queries[group_query[g]], queries[i]);
+    });
+    if (it == end(candidates)) {
+      query_group[i] = group_query.size();
+      candidates.push_back(group_query.size());
+      group_query.push_back(i);
+    } else {
+      query_group[i] = *it;
+    }
+  }
+
+  // Destination preprocessing: once per group.
+  auto group_states = std::vector<search_state>(group_query.size());
+  utl::parallel_for_run(group_query.size(), [&](std::size_t const g) {
+    prepare_destinations(tt, queries[group_query[g]], search_dir, true,
+                         group_states[g]);
+  });
+
+  // Consecutive queries of the same group avoid copying the preprocessing.
+  auto order = std::vector<std::size_t>(queries.size());
+  std::iota(begin(order), end(order), 0U);
+  std::stable_sort(begin(order), end(order),
+                   [&](std::size_t const a, std::size_t const b) {
+                     return query_group[a] < query_group[b];
+                   });
+
+  auto results = std::vector<batch_result>(queries.size());
+  utl::parallel_for_run_threadlocal<worker_state>(
+      order.size(), [&](worker_state& w, std::size_t const i) {
+        auto const q_idx = order[i];
+        auto const g = query_group[q_idx];
+        if (w.group_ != g) {
+          auto const& prepared = group_states[g];
+          w.s_state_.is_destination_ = prepared.is_destination_;
+          w.s_state_.is_via_ = prepared.is_via_;
+          w.s_state_.dist_to_dest_ = prepared.dist_to_dest_;
+          w.s_state_.travel_time_lower_bound_ =
+              prepared.travel_time_lower_bound_;
+          w.group_ = g;
+        }
+        auto const guard = prepared_destinations_guard{w};
+
+        auto const r = raptor_search(tt, rtt, w.s_state_, w.r_state_,
+                                     std::move(queries[q_idx]), search_dir);
+        results[q_idx] = batch_result{.journeys_ = *r.journeys_,
+                                      .interval_ = r.interval_,
+                                      .search_stats_ = r.search_stats_,
+                                      .algo_stats_ = r.algo_stats_};
+      });
+
+  return results;
+}
+
+}  // namespace nigiri::routing
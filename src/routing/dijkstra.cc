@@ -27,7 +27,7 @@ void dijkstra(timetable const& tt,
   dists.resize(tt.n_locations());
   utl::fill(dists, std::numeric_limits<label::dist_t>::max());
 
-  std::map<location_idx_t, label::dist_t> min;
+  auto min = hash_map<location_idx_t, label::dist_t>{};
   auto const update_min = [&](location_idx_t const x, duration_t const d) {
     auto const p = tt.locations_.parents_[x];
     auto const l = (p == location_idx_t::invalid()) ? x : p;
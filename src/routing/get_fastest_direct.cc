@@ -60,10 +60,10 @@ duration_t get_fastest_direct(timetable const& tt,
       continue;
     }
 
-    auto const& footpaths =
-        (dir == direction::kForward ? tt.locations_.footpaths_out_[q.prf_idx_]
-                                    : tt.locations_.footpaths_in_[q.prf_idx_]);
-    for (auto const& fp : footpaths[l.l_]) {
+    auto const footpaths = dir == direction::kForward
+                               ? tt.locations_.footpaths_out(q.prf_idx_, l.l_)
+                               : tt.locations_.footpaths_in(q.prf_idx_, l.l_);
+    for (auto const& fp : footpaths) {
       auto const new_dist =
           l.d_ + adjusted_transfer_time(
                      q.transfer_time_settings_,
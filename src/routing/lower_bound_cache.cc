@@ -0,0 +1,114 @@
+#include "nigiri/routing/lower_bound_cache.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "cista/hash.h"
+
+#include "nigiri/routing/dijkstra.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing {
+
+namespace {
+
+lower_bound_cache::key make_key(query const& q, direction const search_dir) {
+  auto k = lower_bound_cache::key{.search_dir_ = search_dir,
+                                  .dest_match_mode_ = q.dest_match_mode_,
+                                  .prf_idx_ = q.prf_idx_,
+                                  .max_travel_time_ = q.max_travel_time_,
+                                  .destination_ = q.destination_,
+                                  .td_dest_ = {}};
+  std::sort(begin(k.destination_), end(k.destination_),
+            [](offset const& a, offset const& b) {
+              return std::tuple{a.target_, a.duration_, a.transport_mode_id_} <
+                     std::tuple{b.target_, b.duration_, b.transport_mode_id_};
+            });
+  for (auto const& [l, offsets] : q.td_dest_) {
+    k.td_dest_.emplace_back(l, offsets);
+  }
+  std::sort(begin(k.td_dest_), end(k.td_dest_),
+            [](auto const& a, auto const& b) { return a.first < b.first; });
+  return k;
+}
+
+}  // namespace
+
+std::size_t lower_bound_cache::key_hash::operator()(key const& k) const {
+  auto h = cista::BASE_HASH;
+  h = cista::hash_combine(h, static_cast<int>(k.search_dir_),
+                          static_cast<int>(k.dest_match_mode_), k.prf_idx_,
+                          k.max_travel_time_.count());
+  for (auto const& o : k.destination_) {
+    h = cista::hash_combine(h, to_idx(o.target_), o.duration_.count(),
+                            o.transport_mode_id_);
+  }
+  for (auto const& [l, offsets] : k.td_dest_) {
+    h = cista::hash_combine(h, to_idx(l));
+    for (auto const& o : offsets) {
+      h = cista::hash_combine(h, o.valid_from_.time_since_epoch().count(),
+                              o.duration_.count(), o.transport_mode_id_);
+    }
+  }
+  return static_cast<std::size_t>(h);
+}
+
+lower_bound_cache::lower_bound_cache(std::size_t const max_size)
+    : max_size_{std::max(max_size, std::size_t{1U})} {}
+
+lower_bound_cache::lower_bounds_t lower_bound_cache::get_or_compute(
+    timetable const& tt, query const& q, direction const search_dir) {
+  auto k = make_key(q, search_dir);
+
+  {
+    auto const lock = std::scoped_lock{mutex_};
+    if (tt_id_ != tt.id_) {
+      entries_.clear();
+      index_.clear();
+      tt_id_ = tt.id_;
+    }
+
+    if (auto const it = index_.find(k); it != end(index_)) {
+      entries_.splice(begin(entries_), entries_, it->second);
+      return it->second->second;
+    }
+  }
+
+  // Computed without holding the lock: concurrent misses for the same key
+  // compute the same result, the first one to finish is stored.
+  auto lb = std::vector<std::uint16_t>{};
+  dijkstra(tt, q,
+           search_dir == direction::kForward ? tt.fwd_search_lb_graph_
+                                             : tt.bwd_search_lb_graph_,
+           lb);
+  auto result = std::make_shared<std::vector<std::uint16_t> const>(std::move(lb));
+
+  auto const lock = std::scoped_lock{mutex_};
+  if (tt_id_ != tt.id_) {
+    return result;
+  }
+  if (auto const it = index_.find(k); it != end(index_)) {
+    return it->second->second;
+  }
+  entries_.emplace_front(k, result);
+  index_.emplace(std::move(k), begin(entries_));
+  if (entries_.size() > max_size_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  return result;
+}
+
+void lower_bound_cache::clear() {
+  auto const lock = std::scoped_lock{mutex_};
+  entries_.clear();
+  index_.clear();
+  tt_id_ = 0U;
+}
+
+std::size_t lower_bound_cache::size() const {
+  auto const lock = std::scoped_lock{mutex_};
+  return entries_.size();
+}
+
+}  // namespace nigiri::routing
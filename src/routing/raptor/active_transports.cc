@@ -0,0 +1,116 @@
+#include "nigiri/routing/raptor/active_transports.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "utl/helpers/algorithm.h"
+
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing {
+
+namespace {
+constexpr auto const kBits = std::size_t{64U};
+}  // namespace
+
+active_transports::day_entry& active_transports::find_or_add_day(
+    timetable const& tt, std::size_t const day) {
+  if (tt_id_ != tt.id_) {
+    clear();
+    tt_id_ = tt.id_;
+  }
+
+  ++use_count_;
+
+  auto const it = utl::find_if(
+      days_, [&](day_entry const& d) { return d.day_ == day; });
+  if (it != end(days_)) {
+    it->last_use_ = use_count_;
+    last_ = static_cast<std::size_t>(std::distance(begin(days_), it));
+    return *it;
+  }
+
+  if (days_.size() < kMaxCachedDays) {
+    last_ = days_.size();
+    days_.emplace_back();
+  } else {
+    last_ = static_cast<std::size_t>(std::distance(
+        begin(days_),
+        std::min_element(begin(days_), end(days_),
+                         [](day_entry const& a, day_entry const& b) {
+                           return a.last_use_ < b.last_use_;
+                         })));
+  }
+
+  auto& d = days_[last_];
+  d.day_ = day;
+  d.last_use_ = use_count_;
+  d.route_ready_.resize(tt.n_routes());
+  d.active_.resize(static_cast<unsigned>(tt.transport_traffic_days_.size()));
+  utl::fill(d.route_ready_.blocks_, 0U);
+  utl::fill(d.active_.blocks_, 0U);
+  return d;
+}
+
+void active_transports::build_route(timetable const& tt,
+                                    day_entry& d,
+                                    route_idx_t const r) {
+  for (auto const t : tt.route_transport_ranges_[r]) {
+    d.active_.set(to_idx(t),
+                  tt.is_traffic_day(tt.transport_traffic_days_[t], d.day_));
+  }
+  d.route_ready_.set(to_idx(r), true);
+}
+
+transport_idx_t active_transports::first_active(timetable const& tt,
+                                                route_idx_t const r,
+                                                transport_idx_t const from,
+                                                transport_idx_t const to,
+                                                std::size_t const day) {
+  auto const& blocks = get_route(tt, r, day).active_.blocks_;
+  auto const end = to_idx(to);
+  for (auto i = to_idx(from); i < end;) {
+    auto const block = i / kBits;
+    auto const bits = blocks[block] & (~std::uint64_t{0U} << (i % kBits));
+    if (bits != 0U) {
+      auto const t = transport_idx_t{static_cast<transport_idx_t::value_t>(
+          block * kBits + static_cast<std::size_t>(std::countr_zero(bits)))};
+      return t < to ? t : to;
+    }
+    i = (block + 1U) * kBits;
+  }
+  return to;
+}
+
+transport_idx_t active_transports::last_active(timetable const& tt,
+                                               route_idx_t const r,
+                                               transport_idx_t const from,
+                                               transport_idx_t const to,
+                                               std::size_t const day) {
+  auto const& blocks = get_route(tt, r, day).active_.blocks_;
+  auto const begin = to_idx(from);
+  for (auto i = to_idx(to); i > begin;) {
+    auto const block = (i - 1U) / kBits;
+    auto const n_bits = i - block * kBits;
+    auto const mask = n_bits == kBits ? ~std::uint64_t{0U}
+                                      : (std::uint64_t{1U} << n_bits) - 1U;
+    auto const bits = blocks[block] & mask;
+    if (bits != 0U) {
+      auto const t = transport_idx_t{static_cast<transport_idx_t::value_t>(
+          block * kBits + kBits - 1U -
+          static_cast<std::size_t>(std::countl_zero(bits)))};
+      return t >= from ? t : transport_idx_t::invalid();
+    }
+    i = block * kBits;
+  }
+  return transport_idx_t::invalid();
+}
+
+void active_transports::clear() {
+  tt_id_ = 0U;
+  days_.clear();
+  last_ = 0U;
+  use_count_ = 0U;
+}
+
+}  // namespace nigiri::routing
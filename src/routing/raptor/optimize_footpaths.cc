@@ -240,9 +240,8 @@ void optimize_transfers(timetable const& tt,
         if (!stp_to.in_allowed()) {
           continue;
         }
-        for (auto const& fp :
-             tt.locations_
-                 .footpaths_out_[q.prf_idx_][stp_from.get_location_idx()]) {
+        for (auto const& fp : tt.locations_.footpaths_out(
+                 q.prf_idx_, stp_from.get_location_idx())) {
           auto const fp_dur =
               adjusted_transfer_time(q.transfer_time_settings_, fp.duration());
           if (fp_dur >= fp_dur_best ||
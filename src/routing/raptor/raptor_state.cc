@@ -14,11 +14,23 @@ namespace nigiri::routing {
 raptor_state& raptor_state::resize(unsigned const n_locations,
                                    unsigned const n_routes,
                                    unsigned const n_rt_transports) {
+  if (n_locations != n_locations_) {
+    reset_stride_ = 0U;
+    touched_.clear();
+    is_touched_.resize(0U);
+  }
+  is_touched_.resize(n_locations);
   n_locations_ = n_locations;
   tmp_storage_.resize(n_locations * (kMaxVias + 1));
   best_storage_.resize(n_locations * (kMaxVias + 1));
   round_times_storage_.resize(n_locations * (kMaxVias + 1) *
                               (kMaxTransfers + 1));
+  if (record_predecessors_) {
+    predecessors_storage_.resize(n_locations * (kMaxVias + 1) *
+                                 (kMaxTransfers + 1));
+  } else {
+    predecessors_storage_ = {};
+  }
   station_mark_.resize(n_locations);
   prev_station_mark_.resize(n_locations);
   route_mark_.resize(n_routes);
@@ -27,6 +39,17 @@ raptor_state& raptor_state::resize(unsigned const n_locations,
   return *this;
 }
 
+void raptor_state::clear_touched() {
+  if (reset_touched_only()) {
+    for (auto const l : touched_) {
+      is_touched_.set(l, false);
+    }
+  } else {
+    utl::fill(is_touched_.blocks_, 0U);
+  }
+  touched_.clear();
+}
+
 template <via_offset_t Vias>
 void raptor_state::print(timetable const& tt,
                          date::sys_days const base,
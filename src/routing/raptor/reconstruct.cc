@@ -61,9 +61,9 @@ std::optional<journey::leg> find_start_footpath(timetable const& tt,
 
   trace_rc_checking_start_fp;
 
-  auto const& footpaths =
-      kFwd ? tt.locations_.footpaths_in_[q.prf_idx_][leg_start_location]
-           : tt.locations_.footpaths_out_[q.prf_idx_][leg_start_location];
+  auto const footpaths =
+      kFwd ? tt.locations_.footpaths_in(q.prf_idx_, leg_start_location)
+           : tt.locations_.footpaths_out(q.prf_idx_, leg_start_location);
   auto const j_start_time = unix_to_delta(base, j.start_time_);
   auto const round_times = state.get_round_times<Vias>();
   auto const fp_target_time = round_times[0][to_idx(leg_start_location)][0];
@@ -132,13 +132,13 @@ std::optional<journey::leg> find_start_footpath(timetable const& tt,
 }
 
 template <direction SearchDir, via_offset_t Vias>
-void reconstruct_journey_with_vias(timetable const& tt,
-                                   rt_timetable const* rtt,
-                                   query const& q,
-                                   raptor_state const& raptor_state,
-                                   journey& j,
-                                   date::sys_days const base,
-                                   day_idx_t const base_day_idx) {
+unsigned reconstruct_journey_with_vias(timetable const& tt,
+                                       rt_timetable const* rtt,
+                                       query const& q,
+                                       raptor_state const& raptor_state,
+                                       journey& j,
+                                       date::sys_days const base,
+                                       day_idx_t const base_day_idx) {
   constexpr auto const kFwd = SearchDir == direction::kForward;
   auto const dir = [&]<typename T>(T const a) {
     return static_cast<T>((kFwd ? 1 : -1) * a);
@@ -234,7 +234,7 @@ void reconstruct_journey_with_vias(timetable const& tt,
     if (rtt != nullptr) {
       return rtt->bitfields_[rtt->transport_traffic_days_[t]].test(day);
     } else {
-      return tt.bitfields_[tt.transport_traffic_days_[t]].test(day);
+      return tt.is_traffic_day(tt.transport_traffic_days_[t], day);
     }
   };
 
@@ -289,11 +289,74 @@ void reconstruct_journey_with_vias(timetable const& tt,
     return std::nullopt;
   };
 
+  // Fast path: transport recorded by raptor for this label (only available
+  // if raptor_state::record_predecessors_ is set). Recorded entries are
+  // validated exactly like scanned candidates.
+  auto const predecessors = raptor_state.get_predecessors<Vias>();
+  auto n_recorded_hits = 0U;
+  auto const get_recorded_transport =
+      [&](unsigned const k, location_idx_t const l, delta_t const time,
+          bool const is_td_footpath) -> std::optional<journey::leg> {
+    if (predecessors.n_rows_ == 0U) {
+      return std::nullopt;
+    }
+
+    for (auto const& p : predecessors[k][to_idx(l)]) {
+      if (!p.is_valid() || to_idx(p.t_idx_) >= tt.transport_route_.size()) {
+        continue;
+      }
+
+      auto const r = tt.transport_route_[p.t_idx_];
+      auto const location_seq = tt.route_location_seq_[r];
+      if (p.stop_idx_ >= location_seq.size() ||
+          stop{location_seq[p.stop_idx_]}.location_idx() != l ||
+          !is_allowed(q.allowed_claszes_, tt.route_clasz_[r]) ||
+          !is_transport_active(p.t_idx_, to_idx(p.day_))) {
+        continue;
+      }
+
+      auto section_bike_filter = false;
+      if (q.require_bike_transport_ &&
+          !tt.route_bikes_allowed_.test(r.v_ * 2)) {
+        if (!tt.route_bikes_allowed_.test(r.v_ * 2 + 1)) {
+          continue;
+        }
+        section_bike_filter = true;
+      }
+
+      auto const tr = transport{p.t_idx_, p.day_};
+      auto const ev_time = unix_to_delta(
+          base, tt.event_time(tr, p.stop_idx_,
+                              kFwd ? event_type::kArr : event_type::kDep));
+      if (is_td_footpath ? is_better(time, ev_time) : time != ev_time) {
+        continue;
+      }
+
+      auto leg = find_entry_in_prev_round(
+          k,
+          {.t_ = tr,
+           .stop_range_ = interval<stop_idx_t>{0, static_cast<stop_idx_t>(
+                                                      location_seq.size())}},
+          p.stop_idx_, ev_time, section_bike_filter);
+      if (leg.has_value()) {
+        return leg;
+      }
+    }
+
+    return std::nullopt;
+  };
+
   auto const get_transport =
       [&](unsigned const k, location_idx_t const l, delta_t const time,
           bool const is_td_footpath) -> std::optional<journey::leg> {
     trace_reconstruct(" time={}\n", delta_to_unix(base, time));
 
+    if (auto leg = get_recorded_transport(k, l, time, is_td_footpath);
+        leg.has_value()) {
+      ++n_recorded_hits;
+      return leg;
+    }
+
     if (rtt != nullptr) {
       for (auto const& rt_t : rtt->location_rt_transports_[l]) {
         if (!is_allowed(q.allowed_claszes_,
@@ -561,11 +624,20 @@ void reconstruct_journey_with_vias(timetable const& tt,
     }
 
     trace_reconstruct("CHECKING FOOTPATHS OF {}\n", location{tt, l});
-    if (rtt == nullptr || !(kFwd ? rtt->has_td_footpaths_in_
-                                 : rtt->has_td_footpaths_out_)[q.prf_idx_]
-                               .test(l)) {
-      auto const footpaths = kFwd ? tt.locations_.footpaths_in_[q.prf_idx_][l]
-                                  : tt.locations_.footpaths_out_[q.prf_idx_][l];
+    auto const is_set = [&](bitvec_map<location_idx_t> const& bv) {
+      return to_idx(l) < bv.size() && bv.test(l);
+    };
+    auto const rt_td = rtt != nullptr &&
+                       is_set((kFwd ? rtt->has_td_footpaths_in_
+                                    : rtt->has_td_footpaths_out_)[q.prf_idx_]);
+    auto const static_td =
+        !rt_td && q.prf_idx_ != 0U &&
+        is_set((kFwd ? tt.locations_.has_td_footpaths_in_
+                     : tt.locations_.has_td_footpaths_out_)[q.prf_idx_]);
+
+    if (!rt_td && !static_td) {
+      auto const footpaths = kFwd ? tt.locations_.footpaths_in(q.prf_idx_, l)
+                                  : tt.locations_.footpaths_out(q.prf_idx_, l);
       for (auto const& fp : footpaths) {
         auto fp_legs = check_fp(k, l, curr_time, fp, false, true);
         if (fp_legs.has_value()) {
@@ -574,13 +646,13 @@ void reconstruct_journey_with_vias(timetable const& tt,
       }
     }
 
-    if (rtt != nullptr && q.prf_idx_ != 0U &&
-        (kFwd ? rtt->has_td_footpaths_in_
-              : rtt->has_td_footpaths_out_)[q.prf_idx_]
-            .test(l)) {
+    if ((rt_td && q.prf_idx_ != 0U) || static_td) {
       trace_reconstruct("CHECKING TD FOOTPATHS OF {}\n", location{tt, l});
-      auto const td_footpaths = kFwd ? rtt->td_footpaths_in_[q.prf_idx_][l]
-                                     : rtt->td_footpaths_out_[q.prf_idx_][l];
+      auto const td_footpaths =
+          rt_td ? (kFwd ? rtt->td_footpaths_in_[q.prf_idx_][l]
+                        : rtt->td_footpaths_out_[q.prf_idx_][l])
+                : (kFwd ? tt.locations_.td_footpaths_in_[q.prf_idx_][l]
+                        : tt.locations_.td_footpaths_out_[q.prf_idx_][l]);
       auto const unix_now = delta_to_unix(base, curr_time);
       auto legs = std::optional<std::pair<journey::leg, journey::leg>>{};
       for_each_footpath<SearchDir>(
@@ -670,16 +742,18 @@ void reconstruct_journey_with_vias(timetable const& tt,
 #if defined(NIGIRI_TRACE_RECUSTRUCT)
   j.print(std::cout, tt, true);
 #endif
+
+  return n_recorded_hits;
 }
 
 template <direction SearchDir>
-void reconstruct_journey(timetable const& tt,
-                         rt_timetable const* rtt,
-                         query const& q,
-                         raptor_state const& raptor_state,
-                         journey& j,
-                         date::sys_days const base,
-                         day_idx_t const base_day_idx) {
+unsigned reconstruct_journey(timetable const& tt,
+                             rt_timetable const* rtt,
+                             query const& q,
+                             raptor_state const& raptor_state,
+                             journey& j,
+                             date::sys_days const base,
+                             day_idx_t const base_day_idx) {
   static_assert(kMaxVias == 2,
                 "reconstruct.cc needs to be adjusted for kMaxVias");
 
@@ -697,20 +771,22 @@ void reconstruct_journey(timetable const& tt,
   std::unreachable();
 }
 
-template void reconstruct_journey<direction::kForward>(timetable const&,
-                                                       rt_timetable const*,
-                                                       query const&,
-                                                       raptor_state const&,
-                                                       journey&,
-                                                       date::sys_days const,
-                                                       day_idx_t const);
-
-template void reconstruct_journey<direction::kBackward>(timetable const&,
-                                                        rt_timetable const*,
-                                                        query const&,
-                                                        raptor_state const&,
-                                                        journey&,
-                                                        date::sys_days const,
-                                                        day_idx_t const);
+template unsigned reconstruct_journey<direction::kForward>(
+    timetable const&,
+    rt_timetable const*,
+    query const&,
+    raptor_state const&,
+    journey&,
+    date::sys_days const,
+    day_idx_t const);
+
+template unsigned reconstruct_journey<direction::kBackward>(
+    timetable const&,
+    rt_timetable const*,
+    query const&,
+    raptor_state const&,
+    journey&,
+    date::sys_days const,
+    day_idx_t const);
 
 }  // namespace nigiri::routing
@@ -1,5 +1,6 @@
 #include "nigiri/routing/raptor_search.h"
 
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -27,17 +28,20 @@ routing_result<raptor_stats> raptor_search_with_vias(
     search_state& s_state,
     raptor_state& r_state,
     query q,
-    std::optional<std::chrono::seconds> const timeout) {
+    std::optional<std::chrono::seconds> const timeout,
+    std::span<raptor_state> worker_states) {
 
   if (rtt == nullptr) {
     using algo_t = raptor<SearchDir, false, Vias>;
     return search<SearchDir, algo_t>{tt,      rtt,          s_state,
                                      r_state, std::move(q), timeout}
+        .with_workers(worker_states)
         .execute();
   } else {
     using algo_t = raptor<SearchDir, true, Vias>;
     return search<SearchDir, algo_t>{tt,      rtt,          s_state,
                                      r_state, std::move(q), timeout}
+        .with_workers(worker_states)
         .execute();
   }
 }
@@ -49,7 +53,8 @@ routing_result<raptor_stats> raptor_search_with_dir(
     search_state& s_state,
     raptor_state& r_state,
     query q,
-    std::optional<std::chrono::seconds> const timeout) {
+    std::optional<std::chrono::seconds> const timeout,
+    std::span<raptor_state> worker_states) {
   q.sanitize(tt);
   utl::verify(q.via_stops_.size() <= kMaxVias,
               "too many via stops: {}, limit: {}", q.via_stops_.size(),
@@ -60,14 +65,14 @@ routing_result<raptor_stats> raptor_search_with_dir(
 
   switch (q.via_stops_.size()) {
     case 0:
-      return raptor_search_with_vias<SearchDir, 0>(tt, rtt, s_state, r_state,
-                                                   std::move(q), timeout);
+      return raptor_search_with_vias<SearchDir, 0>(
+          tt, rtt, s_state, r_state, std::move(q), timeout, worker_states);
     case 1:
-      return raptor_search_with_vias<SearchDir, 1>(tt, rtt, s_state, r_state,
-                                                   std::move(q), timeout);
+      return raptor_search_with_vias<SearchDir, 1>(
+          tt, rtt, s_state, r_state, std::move(q), timeout, worker_states);
     case 2:
-      return raptor_search_with_vias<SearchDir, 2>(tt, rtt, s_state, r_state,
-                                                   std::move(q), timeout);
+      return raptor_search_with_vias<SearchDir, 2>(
+          tt, rtt, s_state, r_state, std::move(q), timeout, worker_states);
   }
   std::unreachable();
 }
@@ -92,7 +97,8 @@ routing_result<raptor_stats> raptor_search(
     raptor_state& r_state,
     query q,
     direction const search_dir,
-    std::optional<std::chrono::seconds> const timeout) {
+    std::optional<std::chrono::seconds> const timeout,
+    std::span<raptor_state> worker_states) {
   auto span = get_otel_tracer()->StartSpan("raptor_search");
   auto scope = opentelemetry::trace::Scope{span};
   if (span->IsRecording()) {
@@ -142,12 +148,19 @@ routing_result<raptor_stats> raptor_search(
     }
   }
 
+  if (q.record_predecessors_) {
+    r_state.record_predecessors_ = true;
+    for (auto& w : worker_states) {
+      w.record_predecessors_ = true;
+    }
+  }
+
   if (search_dir == direction::kForward) {
     return raptor_search_with_dir<direction::kForward>(
-        tt, rtt, s_state, r_state, std::move(q), timeout);
+        tt, rtt, s_state, r_state, std::move(q), timeout, worker_states);
   } else {
     return raptor_search_with_dir<direction::kBackward>(
-        tt, rtt, s_state, r_state, std::move(q), timeout);
+        tt, rtt, s_state, r_state, std::move(q), timeout, worker_states);
   }
 }
 
@@ -59,9 +59,11 @@ void add_start_times_at_stop(direction const search_dir,
 
   auto const& transport_range = tt.route_transport_ranges_[route_idx];
   for (auto t = transport_range.from_; t != transport_range.to_; ++t) {
-    auto const& traffic_days =
-        rtt == nullptr ? tt.bitfields_[tt.transport_traffic_days_[t]]
-                       : rtt->bitfields_[rtt->transport_traffic_days_[t]];
+    auto const is_active = [&](std::size_t const day) {
+      return rtt == nullptr
+                 ? tt.is_traffic_day(tt.transport_traffic_days_[t], day)
+                 : rtt->bitfields_[rtt->transport_traffic_days_[t]].test(day);
+    };
     auto const stop_time =
         tt.event_mam(t, stop_idx,
                      (search_dir == direction::kForward ? event_type::kDep
@@ -76,7 +78,7 @@ void add_start_times_at_stop(direction const search_dir,
         iv_at_stop.from_, iv_at_stop.to_, t, tt.transport_name(t), stop_time,
         day_offset, stop_time_mam);
     for (auto day = first_day_idx; day <= last_day_idx; ++day) {
-      if (traffic_days.test(to_idx(day - day_offset)) &&
+      if (is_active(to_idx(day - day_offset)) &&
           iv_at_stop.contains(tt.to_unixtime(day, stop_time_mam))) {
         auto const ev_time = tt.to_unixtime(day, stop_time_mam);
         auto const d = get_duration(search_dir, ev_time, offset);
@@ -263,8 +265,8 @@ void get_starts(
     for_each_meta(tt, mode, o.target(), [&](location_idx_t const l) {
       update(l, o.duration());
       if (use_start_footpaths) {
-        auto const footpaths = fwd ? tt.locations_.footpaths_out_[prf_idx][l]
-                                   : tt.locations_.footpaths_in_[prf_idx][l];
+        auto const footpaths = fwd ? tt.locations_.footpaths_out(prf_idx, l)
+                                   : tt.locations_.footpaths_in(prf_idx, l);
         for (auto const& fp : footpaths) {
           update(fp.target(),
                  o.duration() + adjusted_transfer_time(tts, fp.duration()));
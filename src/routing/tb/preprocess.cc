@@ -0,0 +1,441 @@
+#include "nigiri/routing/tb/preprocess.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+#include "cista/io.h"
+
+#include "utl/get_or_create.h"
+#include "utl/parallel_for.h"
+#include "utl/progress_tracker.h"
+#include "utl/to_vec.h"
+
+#include "nigiri/logging.h"
+#include "nigiri/stop.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing::tb {
+
+namespace {
+
+constexpr auto const kMode = cista::mode::WITH_INTEGRITY;
+
+// Number of days to look ahead for a departure after the earliest one.
+constexpr auto const kNDaysToIterate = 2;
+
+struct transfer_candidate {
+  stop_idx_t from_stop_idx_;
+  transport_idx_t to_transport_;
+  stop_idx_t to_stop_idx_;
+  std::int8_t day_offset_;
+  bitfield traffic_days_;
+};
+
+int floor_div(int const a, int const b) {
+  return a / b - ((a % b != 0) && ((a < 0) != (b < 0)) ? 1 : 0);
+}
+
+// Days D where the transport with traffic days `bf` runs on day D + k.
+bitfield shift(bitfield const& bf, int const k) {
+  return k >= 0 ? bf >> static_cast<std::size_t>(k)
+                : bf << static_cast<std::size_t>(-k);
+}
+
+struct departure {
+  int time_;
+  transport_idx_t t_;
+  int day_offset_;
+};
+
+void add_transfers(timetable const& tt,
+                   profile_idx_t const prf_idx,
+                   transport_idx_t const t,
+                   stop_idx_t const i,
+                   location_idx_t const target,
+                   duration_t const duration,
+                   std::vector<departure>& departures,
+                   std::vector<transfer_candidate>& out) {
+  auto const r = tt.transport_route_[t];
+  auto const seq = tt.route_location_seq_[r];
+  auto const t_traffic_days = tt.traffic_days(tt.transport_traffic_days_[t]);
+  auto const needed = tt.event_mam(r, t, i, event_type::kArr).count() +
+                      static_cast<int>(duration.count());
+
+  for (auto const r2 : tt.location_routes_[target]) {
+    auto const seq2 = tt.route_location_seq_[r2];
+    for (auto j = stop_idx_t{0U}; j < seq2.size() - 1U; ++j) {
+      auto const s2 = stop{seq2[j]};
+      if (s2.location_idx() != target || !s2.in_allowed(prf_idx)) {
+        continue;
+      }
+
+      departures.clear();
+      for (auto const u : tt.route_transport_ranges_[r2]) {
+        auto const dep = tt.event_mam(r2, u, j, event_type::kDep).count();
+        auto const first_k = -floor_div(dep - needed, 1440);
+        for (auto k = first_k; k != first_k + kNDaysToIterate; ++k) {
+          departures.push_back({k * 1440 + dep, u, k});
+        }
+      }
+      std::sort(begin(departures), end(departures),
+                [](departure const& a, departure const& b) {
+                  return a.time_ < b.time_;
+                });
+
+      auto remaining = t_traffic_days;
+      for (auto const& d : departures) {
+        if (d.t_ == t && d.day_offset_ == 0) {
+          continue;  // staying in the same transport
+        }
+
+        auto const u_traffic_days =
+            tt.traffic_days(tt.transport_traffic_days_[d.t_]);
+        auto const days = remaining & shift(u_traffic_days, d.day_offset_);
+        if (days.none()) {
+          continue;
+        }
+        remaining &= ~days;
+
+        // U-turn: the target transport could have been entered at the
+        // previous stop of the source transport.
+        auto const is_u_turn = [&]() {
+          if (i < 2U || j + 1U >= seq2.size()) {
+            return false;
+          }
+          auto const prev = stop{seq[i - 1U]};
+          auto const next = stop{seq2[j + 1U]};
+          if (prev.location_idx() != next.location_idx() ||
+              !prev.out_allowed(prf_idx) || !next.in_allowed(prf_idx)) {
+            return false;
+          }
+          auto const prev_arr =
+              tt.event_mam(r, t, static_cast<stop_idx_t>(i - 1U),
+                           event_type::kArr)
+                  .count();
+          auto const next_dep =
+              tt.event_mam(r2, d.t_, static_cast<stop_idx_t>(j + 1U),
+                           event_type::kDep)
+                  .count();
+          auto const transfer_time =
+              tt.locations_.transfer_time_[prev.location_idx()].count();
+          return prev_arr + transfer_time <= d.day_offset_ * 1440 + next_dep;
+        };
+
+        if (!is_u_turn()) {
+          out.push_back(
+              {.from_stop_idx_ = i,
+               .to_transport_ = d.t_,
+               .to_stop_idx_ = j,
+               .day_offset_ = static_cast<std::int8_t>(d.day_offset_),
+               .traffic_days_ = days});
+        }
+
+        if (remaining.none()) {
+          break;
+        }
+      }
+    }
+  }
+}
+
+// Classes of routes whose transfers can replace each other in the transfer
+// reduction: a query that can use a transport of route class `a` also has to
+// be able to use any transport of class `b` (see is_substitute).
+struct route_class {
+  clasz clasz_;
+  std::uint8_t bikes_;  // 0 = no bikes, 1 = on some sections, 2 = everywhere
+};
+
+route_class get_route_class(timetable const& tt, route_idx_t const r) {
+  return {.clasz_ = tt.route_clasz_[r],
+          .bikes_ = static_cast<std::uint8_t>(
+              tt.route_bikes_allowed_.test(to_idx(r) * 2U)       ? 2U
+              : tt.route_bikes_allowed_.test(to_idx(r) * 2U + 1U) ? 1U
+                                                                  : 0U)};
+}
+
+// Clasz and bike filters accepting `a` also accept `b`.
+bool is_substitute(route_class const a, route_class const b) {
+  return a.clasz_ == b.clasz_ && (a.bikes_ == 0U || b.bikes_ == 2U);
+}
+
+struct arrival_times {
+  static constexpr auto const kInf = std::numeric_limits<int>::max();
+
+  bool improve(arrival_times const& o) {
+    auto const improved =
+        o.arr_ < arr_ || o.fp_arr_ < fp_arr_ || o.change_ < change_;
+    arr_ = std::min(arr_, o.arr_);
+    fp_arr_ = std::min(fp_arr_, o.fp_arr_);
+    change_ = std::min(change_, o.change_);
+    return improved;
+  }
+
+  int arr_{kInf};     // arrival with the transport (intermodal destinations)
+  int fp_arr_{kInf};  // arrival incl. footpaths (station destinations)
+  int change_{kInf};  // earliest departure with another transport
+};
+
+// Transfer reduction (Witt, "Trip-Based Public Transit Routing", 2015):
+// a transfer from t is only kept if the target transport improves the
+// arrival (or change) time at some stop compared to staying in t and using
+// the transfers kept at later stops of t. Transfers only replace each other
+// if their target routes pass the same clasz and bike filters.
+//
+// The traffic days of t are split into groups on which the same candidates
+// are valid. Each group is reduced separately.
+void reduce_transfers(timetable const& tt,
+                      profile_idx_t const prf_idx,
+                      transport_idx_t const t,
+                      std::vector<transfer_candidate>& candidates) {
+  if (candidates.empty()) {
+    return;
+  }
+
+  auto groups =
+      std::vector<bitfield>{tt.traffic_days(tt.transport_traffic_days_[t])};
+  for (auto const& c : candidates) {
+    auto const n_groups = groups.size();
+    for (auto i = 0U; i != n_groups; ++i) {
+      auto const in = groups[i] & c.traffic_days_;
+      if (in.any() && in != groups[i]) {
+        groups[i] &= ~c.traffic_days_;
+        groups.push_back(in);
+      }
+    }
+  }
+
+  auto const r = tt.transport_route_[t];
+  auto const seq = tt.route_location_seq_[r];
+  auto const classes =
+      utl::to_vec(candidates, [&](transfer_candidate const& c) {
+        return get_route_class(tt, tt.transport_route_[c.to_transport_]);
+      });
+
+  // times[0] = staying in t, times[i + 1] = kept transfers of class i
+  auto times = std::vector<hash_map<location_idx_t, arrival_times>>{};
+  auto time_classes = std::vector<route_class>{};
+
+  auto const for_each_arrival = [&](location_idx_t const l, int const arr,
+                                    auto&& fn) {
+    fn(l, arrival_times{.arr_ = arr,
+                        .fp_arr_ = arr,
+                        .change_ = arr + static_cast<int>(
+                                             tt.locations_.transfer_time_[l]
+                                                 .count())});
+    for (auto const& fp : tt.locations_.footpaths_out(prf_idx, l)) {
+      auto const fp_arr = arr + static_cast<int>(fp.duration().count());
+      fn(fp.target(),
+         arrival_times{.fp_arr_ = fp_arr, .change_ = fp_arr});
+    }
+  };
+
+  auto const get_times = [&](route_class const c, location_idx_t const l) {
+    auto best = arrival_times{};
+    for (auto i = 0U; i != times.size(); ++i) {
+      if (i != 0U && !is_substitute(c, time_classes[i - 1U])) {
+        continue;
+      }
+      if (auto const it = times[i].find(l); it != end(times[i])) {
+        best.improve(it->second);
+      }
+    }
+    return best;
+  };
+
+  auto const get_class_times = [&](route_class const c)
+      -> hash_map<location_idx_t, arrival_times>& {
+    for (auto i = 0U; i != time_classes.size(); ++i) {
+      if (time_classes[i].clasz_ == c.clasz_ &&
+          time_classes[i].bikes_ == c.bikes_) {
+        return times[i + 1U];
+      }
+    }
+    time_classes.push_back(c);
+    return times.emplace_back();
+  };
+
+  auto kept = std::vector<bitfield>(candidates.size());
+  for (auto const& g : groups) {
+    times.clear();
+    time_classes.clear();
+    times.emplace_back();
+
+    auto it = candidates.size();
+    for (auto i = static_cast<stop_idx_t>(seq.size() - 1U); i != 0U; --i) {
+      auto const s = stop{seq[i]};
+      if (s.out_allowed(prf_idx)) {
+        for_each_arrival(
+            s.location_idx(), tt.event_mam(r, t, i, event_type::kArr).count(),
+            [&](location_idx_t const l, arrival_times const& a) {
+              times[0][l].improve(a);
+            });
+      }
+
+      for (; it != 0U && candidates[it - 1U].from_stop_idx_ == i; --it) {
+        auto const& c = candidates[it - 1U];
+        if ((c.traffic_days_ & g).none()) {
+          continue;
+        }
+
+        auto const c_class = classes[it - 1U];
+        auto const r2 = tt.transport_route_[c.to_transport_];
+        auto const seq2 = tt.route_location_seq_[r2];
+        auto arrivals = std::vector<std::pair<location_idx_t, arrival_times>>{};
+        auto keep = false;
+        for (auto j = static_cast<stop_idx_t>(c.to_stop_idx_ + 1U);
+             j < seq2.size(); ++j) {
+          auto const s2 = stop{seq2[j]};
+          if (!s2.out_allowed(prf_idx)) {
+            continue;
+          }
+          for_each_arrival(
+              s2.location_idx(),
+              c.day_offset_ * 1440 +
+                  tt.event_mam(r2, c.to_transport_, j, event_type::kArr)
+                      .count(),
+              [&](location_idx_t const l, arrival_times const& a) {
+                keep = get_times(c_class, l).improve(a) || keep;
+                arrivals.emplace_back(l, a);
+              });
+        }
+
+        if (keep) {
+          kept[it - 1U] |= g;
+          auto& class_times = get_class_times(c_class);
+          for (auto const& [l, a] : arrivals) {
+            class_times[l].improve(a);
+          }
+        }
+      }
+    }
+  }
+
+  for (auto i = 0U; i != candidates.size(); ++i) {
+    candidates[i].traffic_days_ = kept[i];
+  }
+  std::erase_if(candidates, [](transfer_candidate const& c) {
+    return c.traffic_days_.none();
+  });
+}
+
+// Later transports of the route (same start day) are never earlier.
+bool is_fifo(timetable const& tt, route_idx_t const r) {
+  auto const transports = tt.route_transport_ranges_[r];
+  auto const n_stops =
+      static_cast<stop_idx_t>(tt.route_location_seq_[r].size());
+  for (auto i = stop_idx_t{0U}; i != n_stops; ++i) {
+    for (auto const ev : {event_type::kArr, event_type::kDep}) {
+      if ((i == 0U && ev == event_type::kArr) ||
+          (i == n_stops - 1U && ev == event_type::kDep)) {
+        continue;
+      }
+      for (auto t = to_idx(transports.from_); t + 1U < to_idx(transports.to_);
+           ++t) {
+        if (tt.event_mam(r, transport_idx_t{t}, i, ev).count() >
+            tt.event_mam(r, transport_idx_t{t + 1U}, i, ev).count()) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+tb_data preprocess(timetable const& tt, profile_idx_t const prf_idx) {
+  auto const timer = scoped_timer{"tb.preprocess"};
+
+  auto const n_transports = tt.transport_traffic_days_.size();
+  auto transfers = std::vector<std::vector<transfer_candidate>>(n_transports);
+  auto n_candidates = std::atomic_size_t{0U};
+
+  auto const progress_tracker = utl::get_active_progress_tracker();
+  progress_tracker->status("Compute transfers").in_high(n_transports);
+  utl::parallel_for_run(n_transports, [&](std::size_t const idx) {
+    auto const t =
+        transport_idx_t{static_cast<transport_idx_t::value_t>(idx)};
+    auto const seq = tt.route_location_seq_[tt.transport_route_[t]];
+    auto departures = std::vector<departure>{};
+    auto& out = transfers[idx];
+    for (auto i = stop_idx_t{1U}; i != seq.size(); ++i) {
+      auto const s = stop{seq[i]};
+      if (!s.out_allowed(prf_idx)) {
+        continue;
+      }
+
+      auto const l = s.location_idx();
+      add_transfers(tt, prf_idx, t, i, l, tt.locations_.transfer_time_[l],
+                    departures, out);
+      for (auto const& fp : tt.locations_.footpaths_out(prf_idx, l)) {
+        add_transfers(tt, prf_idx, t, i, fp.target(), fp.duration(),
+                      departures, out);
+      }
+    }
+    n_candidates += out.size();
+    reduce_transfers(tt, prf_idx, t, out);
+    progress_tracker->increment();
+  });
+
+  auto d = tb_data{};
+  d.prf_idx_ = prf_idx;
+  d.fifo_routes_.resize(tt.n_routes());
+  for (auto i = 0U; i != tt.n_routes(); ++i) {
+    auto const r = route_idx_t{i};
+    d.fifo_routes_.set(r, is_fifo(tt, r));
+  }
+
+  auto bitfield_indices = hash_map<bitfield, bitfield_idx_t>{};
+  auto const get_bitfield_idx = [&](bitfield const& bf) {
+    return utl::get_or_create(bitfield_indices, bf, [&]() {
+      auto const idx = bitfield_idx_t{
+          static_cast<bitfield_idx_t::value_t>(d.bitfields_.size())};
+      d.bitfields_.emplace_back(bf);
+      return idx;
+    });
+  };
+
+  auto n_transfers = std::size_t{0U};
+  auto segment_transfers = std::vector<transfer>{};
+  for (auto idx = 0U; idx != n_transports; ++idx) {
+    auto const t = transport_idx_t{idx};
+    auto const n_stops = static_cast<stop_idx_t>(
+        tt.route_location_seq_[tt.transport_route_[t]].size());
+    d.transport_first_segment_.emplace_back(
+        static_cast<segment_idx_t::value_t>(d.segment_transfers_.size()));
+
+    auto const& candidates = transfers[to_idx(t)];
+    auto it = begin(candidates);
+    for (auto i = stop_idx_t{0U}; i != n_stops; ++i) {
+      segment_transfers.clear();
+      for (; it != end(candidates) && it->from_stop_idx_ == i; ++it) {
+        segment_transfers.push_back(
+            {.to_transport_ = it->to_transport_,
+             .to_stop_idx_ = it->to_stop_idx_,
+             .day_offset_ = it->day_offset_,
+             .traffic_days_ = get_bitfield_idx(it->traffic_days_)});
+      }
+      n_transfers += segment_transfers.size();
+      d.segment_transfers_.emplace_back(segment_transfers);
+    }
+  }
+
+  log(log_lvl::info, "tb.preprocess",
+      "{} transfers ({} before reduction), {} bitfields", n_transfers,
+      n_candidates.load(), d.bitfields_.size());
+
+  return d;
+}
+
+void tb_data::write(std::filesystem::path const& p) const {
+  return cista::write<kMode, tb_data>(p, *this);
+}
+
+cista::wrapped<tb_data> tb_data::read(std::filesystem::path const& p) {
+  return cista::read<tb_data, kMode>(p);
+}
+
+}  // namespace nigiri::routing::tb
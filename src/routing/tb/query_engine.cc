@@ -0,0 +1,515 @@
+#include "nigiri/routing/tb/query_engine.h"
+
+#include <algorithm>
+
+#include "utl/enumerate.h"
+#include "utl/helpers/algorithm.h"
+#include "utl/verify.h"
+
+#include "nigiri/for_each_meta.h"
+#include "nigiri/routing/raptor/reconstruct.h"
+#include "nigiri/special_stations.h"
+#include "nigiri/stop.h"
+#include "nigiri/td_footpath.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing::tb {
+
+template <direction SearchDir>
+query_engine<SearchDir>::query_engine(
+    timetable const& tt,
+    rt_timetable const* rtt,
+    query_state& state,
+    bitvec& is_dest,
+    std::array<bitvec, kMaxVias>&,
+    std::vector<std::uint16_t>& dist_to_dest,
+    hash_map<location_idx_t, std::vector<td_offset>> const& td_dist_to_dest,
+    std::vector<std::uint16_t>&,
+    std::vector<via_stop> const& via_stops,
+    day_idx_t,
+    clasz_mask_t const allowed_claszes,
+    bool const require_bike_transport,
+    bool const is_wheelchair,
+    transfer_time_settings const& tts)
+    : tt_{tt},
+      state_{state},
+      tbd_{state.tbd_},
+      is_dest_{is_dest},
+      dist_to_end_{dist_to_dest},
+      td_dist_to_end_{td_dist_to_dest},
+      dest_dist_{dist_to_dest.empty() ? state.dest_dist_ : dist_to_dest},
+      allowed_claszes_{allowed_claszes},
+      require_bike_transport_{require_bike_transport},
+      is_wheelchair_{is_wheelchair} {
+  utl::verify(rtt == nullptr, "tb: real-time updates are not supported");
+  utl::verify(via_stops.empty(), "tb: via stops are not supported");
+  utl::verify(tts.default_, "tb: transfer time settings are not supported");
+  utl::verify(tbd_.transport_first_segment_.size() ==
+                      tt.transport_traffic_days_.size() &&
+                  tbd_.fifo_routes_.size() == tt.n_routes(),
+              "tb: transfer set does not match the timetable");
+
+  reset_arrivals();
+  state_.reached_.resize(tt.n_routes());
+  state_.journeys_.clear();
+
+  // Station destinations: arrival at the destination or a footpath to it.
+  // Intermodal destinations use dist_to_dest directly.
+  if (dist_to_dest.empty()) {
+    state_.dest_dist_.resize(tt.n_locations());
+    utl::fill(state_.dest_dist_, kUnreachable);
+    is_dest.for_each_set_bit([&](std::uint64_t const i) {
+      state_.dest_dist_[i] = 0U;
+      for (auto const& fp :
+           tt.locations_.footpaths_in(tbd_.prf_idx_, location_idx_t{i})) {
+        auto& dist = state_.dest_dist_[to_idx(fp.target())];
+        dist =
+            std::min(dist, static_cast<std::uint16_t>(fp.duration().count()));
+      }
+    });
+  }
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::execute(unixtime_t const start_time,
+                                      std::uint8_t const max_transfers,
+                                      unixtime_t const worst_time_at_dest,
+                                      profile_idx_t const prf_idx,
+                                      pareto_set<journey>& results) {
+  utl::verify(prf_idx == tbd_.prf_idx_,
+              "tb: transfer set computed for profile {}, query profile {}",
+              tbd_.prf_idx_, prf_idx);
+
+  auto const n_rounds = std::min(max_transfers, kMaxTransfers) + 1U;
+  for (auto& time_at_dest : time_at_dest_) {
+    time_at_dest = std::min(time_at_dest, worst_time_at_dest);
+  }
+  best_.fill(dest_label{});
+
+  reset_reached();
+  state_.q_.clear();
+  for (auto i = 0U; i != state_.starts_.size(); ++i) {
+    enqueue_first(i);
+  }
+
+  // Round k: transports entered after k transfers.
+  auto round_begin = std::uint32_t{0U};
+  for (auto k = 0U; k != n_rounds; ++k) {
+    auto const round_end = static_cast<std::uint32_t>(state_.q_.size());
+    if (round_begin == round_end) {
+      break;
+    }
+
+    for (auto e = round_begin; e != round_end; ++e) {
+      check_dest(k, e);
+    }
+    if (k + 1U != n_rounds) {
+      for (auto e = round_begin; e != round_end; ++e) {
+        relax_transfers(k, e);
+      }
+    }
+
+    round_begin = round_end;
+  }
+
+  for (auto k = 0U; k != n_rounds; ++k) {
+    if (best_[k].entry_ == kNoEntry) {
+      continue;
+    }
+
+    auto label =
+        make_label(start_time, static_cast<std::uint8_t>(k), best_[k]);
+    auto const optimal = std::get<0>(
+        results.add(journey{.legs_ = {},
+                            .start_time_ = start_time,
+                            .dest_time_ = label.dest_time_,
+                            .dest_ = label.dest_,
+                            .transfers_ = label.transfers_}));
+    if (optimal) {
+      state_.journeys_.emplace_back(std::move(label));
+    }
+  }
+}
+
+template <direction SearchDir>
+bool query_engine<SearchDir>::is_route_allowed(route_idx_t const r) const {
+  return is_allowed(allowed_claszes_, tt_.route_clasz_[r]) &&
+         (!require_bike_transport_ ||
+          tt_.route_bikes_allowed_.test(to_idx(r) * 2U) ||
+          tt_.route_bikes_allowed_.test(to_idx(r) * 2U + 1U));
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::reset_reached() {
+  for (auto const r : state_.reached_routes_) {
+    state_.reached_[to_idx(r)].clear();
+  }
+  state_.reached_routes_.clear();
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::enqueue_first(std::uint32_t const start_idx) {
+  auto const [l, time_at_stop] = state_.starts_[start_idx];
+  auto const n_days = tt_.internal_interval_days().size().count();
+  auto const from = tt_.internal_interval_days().from_;
+
+  for (auto const r : tt_.location_routes_[l]) {
+    if (!is_route_allowed(r)) {
+      continue;
+    }
+
+    auto const seq = tt_.route_location_seq_[r];
+    for (auto i = stop_idx_t{0U}; i + 1U < seq.size(); ++i) {
+      auto const stp = stop{seq[i]};
+      if (stp.location_idx() != l ||
+          !stp.can_start<SearchDir>(is_wheelchair_)) {
+        continue;
+      }
+
+      // First departure of each transport. Only departures before the
+      // latest useful arrival at the destination are relevant. On FIFO
+      // routes, the earliest departure covers all later ones.
+      auto const fifo = tbd_.fifo_routes_.test(r);
+      auto best_time = time_at_dest_.front();
+      auto best = transport::invalid();
+      for (auto const t : tt_.route_transport_ranges_[r]) {
+        auto const dep = tt_.event_mam(r, t, i, event_type::kDep).as_duration();
+        auto day = std::max(0, static_cast<int>(std::chrono::ceil<date::days>(
+                                                     time_at_stop - from - dep)
+                                                     .count()));
+        for (; day < n_days; ++day) {
+          auto const d = day_idx_t{static_cast<day_idx_t::value_t>(day)};
+          auto const dep_time = tt_.to_unixtime(d) + dep;
+          if (dep_time >= best_time) {
+            break;
+          }
+          if (tt_.is_traffic_day(tt_.transport_traffic_days_[t],
+                                 static_cast<std::size_t>(day))) {
+            if (fifo) {
+              best_time = dep_time;
+              best = transport{t, d};
+            } else {
+              enqueue(t, d, i, queue_entry::kNoParent, 0U, start_idx);
+            }
+            break;
+          }
+        }
+      }
+
+      if (best.is_valid()) {
+        enqueue(best.t_idx_, best.day_, i, queue_entry::kNoParent, 0U,
+                start_idx);
+      }
+    }
+  }
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::enqueue(transport_idx_t const t,
+                                      day_idx_t const day,
+                                      stop_idx_t const i,
+                                      std::uint32_t const parent,
+                                      stop_idx_t const parent_exit,
+                                      std::uint32_t const start_idx) {
+  auto const r = tt_.transport_route_[t];
+  if (!is_route_allowed(r)) {
+    return;
+  }
+
+  auto to = static_cast<stop_idx_t>(tt_.route_location_seq_[r].size());
+  if (require_bike_transport_ &&
+      !tt_.route_bikes_allowed_.test(to_idx(r) * 2U)) {
+    // Ride only until the first section without bike transport.
+    auto const sections = tt_.route_bikes_allowed_per_section_[r];
+    auto j = i;
+    while (j + 1U < to && sections[j]) {
+      ++j;
+    }
+    to = static_cast<stop_idx_t>(j + 1U);
+    if (to <= i + 1U) {
+      return;
+    }
+  }
+
+  auto const fifo = tbd_.fifo_routes_.test(r);
+  auto const covers = [&](reached_entry const& a, transport_idx_t const b) {
+    return a.day_ == day && (a.t_ == b || (fifo && a.t_ < b));
+  };
+
+  auto& reached = state_.reached_[to_idx(r)];
+  for (auto const& x : reached) {
+    if (covers(x, t)) {
+      if (x.stop_ <= i) {
+        ++stats_.n_segments_pruned_;
+        return;
+      }
+      to = std::min(to, x.stop_);
+    }
+  }
+
+  if (reached.empty()) {
+    state_.reached_routes_.push_back(r);
+  }
+  std::erase_if(reached, [&](reached_entry const& x) {
+    return x.stop_ >= i && x.day_ == day &&
+           (x.t_ == t || (fifo && t < x.t_));
+  });
+  reached.push_back({.t_ = t, .day_ = day, .stop_ = i});
+
+  ++stats_.n_segments_enqueued_;
+  state_.q_.push_back({.t_ = t,
+                       .day_ = day,
+                       .from_ = i,
+                       .to_ = to,
+                       .parent_ = parent,
+                       .parent_exit_ = parent_exit,
+                       .start_ = start_idx});
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::check_dest(unsigned const k,
+                                         std::uint32_t const entry) {
+  auto const x = state_.q_[entry];
+  auto const seq = tt_.route_location_seq_[tt_.transport_route_[x.t_]];
+  for (auto i = static_cast<stop_idx_t>(x.from_ + 1U); i < x.to_; ++i) {
+    auto const arr = tt_.event_time({x.t_, x.day_}, i, event_type::kArr);
+    if (arr >= time_at_dest_[k]) {
+      break;
+    }
+
+    auto const stp = stop{seq[i]};
+    if (!stp.can_finish<SearchDir>(is_wheelchair_)) {
+      continue;
+    }
+
+    auto const l = stp.location_idx();
+    auto dest_time = unixtime_t::max();
+    if (dest_dist_[to_idx(l)] != kUnreachable) {
+      dest_time = arr + duration_t{dest_dist_[to_idx(l)]};
+    } else if (auto const it = td_dist_to_end_.find(l);
+               it != end(td_dist_to_end_)) {
+      auto const duration = get_td_duration<SearchDir>(it->second, arr);
+      if (duration.has_value()) {
+        dest_time = arr + *duration;
+      }
+    }
+
+    if (dest_time < time_at_dest_[k]) {
+      ++stats_.n_dest_improvements_;
+      best_[k] = {.time_ = dest_time, .entry_ = entry, .exit_ = i};
+      update_time_at_dest(k, dest_time);
+    }
+  }
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::relax_transfers(unsigned const k,
+                                              std::uint32_t const entry) {
+  auto const x = state_.q_[entry];
+  for (auto i = static_cast<stop_idx_t>(x.from_ + 1U); i < x.to_; ++i) {
+    if (tt_.event_time({x.t_, x.day_}, i, event_type::kArr) >=
+        time_at_dest_[k + 1U]) {
+      break;
+    }
+
+    for (auto const& tr : tbd_.segment_transfers_[tbd_.get_segment(x.t_, i)]) {
+      if (!tbd_.bitfields_[tr.traffic_days_].test(to_idx(x.day_))) {
+        continue;
+      }
+      ++stats_.n_transfers_relaxed_;
+      enqueue(tr.to_transport_,
+              day_idx_t{static_cast<day_idx_t::value_t>(to_idx(x.day_) +
+                                                        tr.day_offset_)},
+              tr.to_stop_idx_, entry, i, x.start_);
+    }
+  }
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::update_time_at_dest(unsigned const k,
+                                                  unixtime_t const t) {
+  for (auto i = k; i != time_at_dest_.size(); ++i) {
+    time_at_dest_[i] = std::min(time_at_dest_[i], t);
+  }
+}
+
+template <direction SearchDir>
+location_idx_t query_engine<SearchDir>::get_dest(
+    location_idx_t const exit,
+    unixtime_t const arr,
+    unixtime_t const dest_time) const {
+  if (!dist_to_end_.empty()) {
+    return get_special_station(special_station::kEnd);
+  }
+  if (is_dest_[to_idx(exit)] && arr == dest_time) {
+    return exit;
+  }
+  for (auto const& fp : tt_.locations_.footpaths_out(tbd_.prf_idx_, exit)) {
+    if (is_dest_[to_idx(fp.target())] && arr + fp.duration() == dest_time) {
+      return fp.target();
+    }
+  }
+  throw utl::fail("tb: no destination reached from {} at {}", exit, arr);
+}
+
+template <direction SearchDir>
+journey_label query_engine<SearchDir>::make_label(
+    unixtime_t const start_time,
+    std::uint8_t const transfers,
+    dest_label const& dest) const {
+  auto const& start = state_.starts_[state_.q_[dest.entry_].start_];
+  auto label = journey_label{.start_time_ = start_time,
+                             .dest_time_ = dest.time_,
+                             .dest_ = location_idx_t::invalid(),
+                             .transfers_ = transfers,
+                             .start_location_ = start.first,
+                             .time_at_start_location_ = start.second,
+                             .transports_ = {}};
+
+  auto exit = dest.exit_;
+  for (auto e = dest.entry_; e != queue_entry::kNoParent;) {
+    auto const& x = state_.q_[e];
+    label.transports_.push_back(
+        {.t_ = transport{x.t_, x.day_}, .enter_ = x.from_, .exit_ = exit});
+    exit = x.parent_exit_;
+    e = x.parent_;
+  }
+  std::reverse(begin(label.transports_), end(label.transports_));
+
+  auto const& last = label.transports_.back();
+  auto const r = tt_.transport_route_[last.t_.t_idx_];
+  auto const seq = tt_.route_location_seq_[r];
+  label.dest_ = get_dest(
+      stop{seq[last.exit_]}.location_idx(),
+      tt_.event_time(last.t_, last.exit_, event_type::kArr), dest.time_);
+
+  return label;
+}
+
+template <direction SearchDir>
+void query_engine<SearchDir>::reconstruct(query const& q, journey& j) const {
+  auto const it = std::find_if(
+      state_.journeys_.rbegin(), state_.journeys_.rend(),
+      [&](journey_label const& x) {
+        return x.start_time_ == j.start_time_ &&
+               x.dest_time_ == j.dest_time_ && x.transfers_ == j.transfers_ &&
+               x.dest_ == j.dest_;
+      });
+  utl::verify(it != state_.journeys_.rend(), "tb: journey not found");
+
+  auto const& label = *it;
+  auto const location = [&](journey_transport const& x,
+                            stop_idx_t const stop_idx) {
+    auto const r = tt_.transport_route_[x.t_.t_idx_];
+    return stop{tt_.route_location_seq_[r][stop_idx]}.location_idx();
+  };
+  auto const is_journey_start = [&](location_idx_t const l) {
+    return utl::any_of(q.start_, [&](offset const& o) {
+      return matches(tt_, q.start_match_mode_, o.target(), l);
+    });
+  };
+
+  // First leg: intermodal offset, footpath or none (start location).
+  auto const l0 = label.start_location_;
+  auto const t0 = label.time_at_start_location_;
+  if (q.start_match_mode_ == location_match_mode::kIntermodal) {
+    auto const o = utl::find_if(q.start_, [&](offset const& x) {
+      return x.duration() == t0 - j.start_time_ &&
+             matches(tt_, q.start_match_mode_, x.target(), l0);
+    });
+    if (o != end(q.start_)) {
+      j.add(journey::leg{SearchDir,
+                         get_special_station(special_station::kStart), l0,
+                         j.start_time_, t0, *o});
+    } else {
+      auto const td = q.td_start_.find(l0);
+      utl::verify(td != end(q.td_start_), "tb: journey start not found");
+      j.add(journey::leg{
+          SearchDir, get_special_station(special_station::kStart), l0,
+          j.start_time_, t0,
+          offset{l0, t0 - j.start_time_,
+                 td->second.back().transport_mode_id_}});
+    }
+  } else if (t0 != j.start_time_ || !is_journey_start(l0)) {
+    auto found = false;
+    for (auto const& fp : tt_.locations_.footpaths_in(tbd_.prf_idx_, l0)) {
+      if (j.start_time_ + fp.duration() == t0 &&
+          is_journey_start(fp.target())) {
+        j.add(journey::leg{SearchDir, fp.target(), l0, j.start_time_, t0,
+                           footpath{fp.target(), fp.duration()}});
+        found = true;
+        break;
+      }
+    }
+    utl::verify(found, "tb: journey start not found");
+  }
+
+  // Transports and the transfers between them.
+  for (auto const [n, x] : utl::enumerate(label.transports_)) {
+    auto const from = location(x, x.enter_);
+    auto const to = location(x, x.exit_);
+    auto const arr = tt_.event_time(x.t_, x.exit_, event_type::kArr);
+    auto const n_stops = static_cast<stop_idx_t>(
+        tt_.route_location_seq_[tt_.transport_route_[x.t_.t_idx_]].size());
+    j.add(journey::leg{
+        SearchDir, from, to,
+        tt_.event_time(x.t_, x.enter_, event_type::kDep), arr,
+        journey::run_enter_exit{
+            rt::run{.t_ = x.t_,
+                    .stop_range_ = interval<stop_idx_t>{0U, n_stops}},
+            x.enter_, x.exit_}});
+
+    if (n + 1U == label.transports_.size()) {
+      break;
+    }
+
+    auto const& next = label.transports_[n + 1U];
+    auto const next_from = location(next, next.enter_);
+    auto duration = std::optional<duration_t>{};
+    if (next_from == to) {
+      duration = tt_.locations_.transfer_time_[to];
+    } else {
+      for (auto const& fp : tt_.locations_.footpaths_out(tbd_.prf_idx_, to)) {
+        if (fp.target() == next_from) {
+          duration = fp.duration();
+          break;
+        }
+      }
+    }
+    utl::verify(duration.has_value(), "tb: transfer {} -> {} not found", to,
+                next_from);
+    j.add(journey::leg{SearchDir, to, next_from, arr, arr + *duration,
+                       footpath{next_from, *duration}});
+  }
+
+  // Last leg: intermodal offset or footpath to the destination.
+  auto const& last = label.transports_.back();
+  auto const exit = location(last, last.exit_);
+  auto const arr = tt_.event_time(last.t_, last.exit_, event_type::kArr);
+  auto const duration = j.dest_time_ - arr;
+  if (q.dest_match_mode_ == location_match_mode::kIntermodal) {
+    auto const o = utl::find_if(q.destination_, [&](offset const& x) {
+      return x.duration() == duration &&
+             matches(tt_, q.dest_match_mode_, x.target(), exit);
+    });
+    if (o != end(q.destination_)) {
+      j.add(journey::leg{SearchDir, exit, j.dest_, arr, j.dest_time_,
+                         offset{exit, duration, o->transport_mode_id_}});
+    } else {
+      auto const td = q.td_dest_.find(exit);
+      utl::verify(td != end(q.td_dest_), "tb: journey destination not found");
+      j.add(journey::leg{
+          SearchDir, exit, j.dest_, arr, j.dest_time_,
+          offset{exit, duration, td->second.back().transport_mode_id_}});
+    }
+  } else if (exit != j.dest_) {
+    j.add(journey::leg{SearchDir, exit, j.dest_, arr, j.dest_time_,
+                       footpath{j.dest_, duration}});
+  }
+
+  optimize_footpaths<SearchDir>(tt_, nullptr, q, j);
+}
+
+template struct query_engine<direction::kForward>;
+
+}  // namespace nigiri::routing::tb
@@ -0,0 +1,20 @@
+#include "nigiri/routing/tb/tb_search.h"
+
+#include <utility>
+
+#include "nigiri/timetable.h"
+
+namespace nigiri::routing::tb {
+
+routing_result<query_stats> tb_search(timetable const& tt,
+                                      search_state& s_state,
+                                      query_state& q_state,
+                                      query q) {
+  q.sanitize(tt);
+  using algo_t = query_engine<direction::kForward>;
+  return search<direction::kForward, algo_t>{tt, nullptr, s_state, q_state,
+                                             std::move(q)}
+      .execute();
+}
+
+}  // namespace nigiri::routing::tb
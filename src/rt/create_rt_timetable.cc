@@ -9,7 +9,16 @@ rt_timetable create_rt_timetable(timetable const& tt,
                                  date::sys_days const base_day) {
   auto rtt = rt_timetable{};
   rtt.transport_traffic_days_ = tt.transport_traffic_days_;
-  rtt.bitfields_ = tt.bitfields_;
+  if (tt.has_compressed_bitfields()) {
+    // Real-time updates modify traffic days: keep them uncompressed.
+    rtt.bitfields_.resize(
+        static_cast<bitfield_idx_t::value_t>(tt.n_bitfields()));
+    for (auto i = bitfield_idx_t{0U}; i != rtt.bitfields_.size(); ++i) {
+      rtt.bitfields_[i] = tt.traffic_days(i);
+    }
+  } else {
+    rtt.bitfields_ = tt.bitfields_;
+  }
   rtt.base_day_ = base_day;
   rtt.base_day_idx_ = tt.day_idx(rtt.base_day_);
   // resize for later memory accesses
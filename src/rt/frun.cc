@@ -1,5 +1,6 @@
 #include "nigiri/rt/frun.h"
 
+#include <algorithm>
 #include <iterator>
 #include <span>
 #include <variant>
@@ -109,7 +110,7 @@ trip_idx_t run_stop::get_trip_idx(event_type const ev_type) const noexcept {
 
 std::string_view run_stop::trip_display_name(
     event_type const ev_type) const noexcept {
-  return tt().trip_display_names_[get_trip_idx(ev_type)].view();
+  return tt().trip_display_name(get_trip_idx(ev_type));
 }
 
 stop_idx_t run_stop::section_idx(event_type const ev_type) const noexcept {
@@ -537,15 +538,19 @@ void run_stop::print(std::ostream& out,
 
     out << "  [";
     for (auto const& trip_idx : merged_trips) {
-      auto j = 0U;
-
-      for (auto const [dbg, id] :
-           utl::zip(tt.trip_debug_.at(trip_idx), tt.trip_ids_.at(trip_idx))) {
-        if (j++ != 0) {
+      auto const ids = tt.trip_ids_.at(trip_idx);
+
+      // One entry per debug info (if the cold data is attached).
+      auto const n_entries =
+          tt.has_cold_data(trip_idx)
+              ? std::min(ids.size(), tt.trip_debug_[trip_idx].size())
+              : ids.size();
+      for (auto j = 0U; j != n_entries; ++j) {
+        auto const id = ids[j];
+        if (j != 0U) {
           out << ", ";
         }
-        out << "{name=" << tt.trip_display_names_.at(trip_idx).view()
-            << ", day=";
+        out << "{name=" << tt.trip_display_name(trip_idx) << ", day=";
         date::to_stream(
             out, "%F",
             tt.internal_interval_days().from_ + to_idx(fr_->t_.day_) * 1_days);
@@ -35,13 +35,7 @@ void resolve_static(date::sys_days const today,
   using loader::gtfs::parse_date;
 
   auto const& trip_id = td.trip_id();
-  auto const lb = std::lower_bound(
-      begin(tt.trip_id_to_idx_), end(tt.trip_id_to_idx_), trip_id,
-      [&](pair<trip_id_idx_t, trip_idx_t> const& a, auto&& b) {
-        return std::tuple(tt.trip_id_src_[a.first],
-                          tt.trip_id_strings_[a.first].view()) <
-               std::tuple(src, static_cast<std::string_view>(b));
-      });
+  auto const lb = tt.find_trip_id(src, trip_id);
 
   auto const start_date = td.has_start_date()
                               ? std::make_optional(parse_date(
@@ -86,8 +80,8 @@ void resolve_static(date::sys_days const today,
         continue;
       }
 
-      auto const& traffic_days = tt.bitfields_[tt.transport_traffic_days_[t]];
-      if (traffic_days.test(static_cast<std::size_t>(day_idx))) {
+      if (tt.is_traffic_day(tt.transport_traffic_days_[t],
+                            static_cast<std::size_t>(day_idx))) {
         r.t_ = transport{t, day_idx_t{day_idx}};
         r.stop_range_ = stop_range;
         trip = i->second;
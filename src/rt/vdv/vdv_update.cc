@@ -195,6 +195,7 @@ std::optional<rt::run> updater::find_run(std::string_view vdv_run_id,
   }
 
   auto candidates = std::vector<candidate>{};
+  auto event_times_buf = std::vector<delta>{};
 
   for (auto const& vdv_stop : vdv_stops) {
     if (vdv_stop.l_ == location_idx_t::invalid()) {
@@ -222,7 +223,8 @@ std::optional<rt::run> updater::find_run(std::string_view vdv_run_id,
 
           for (auto const [nigiri_ev_time_idx, nigiri_ev_time] :
                utl::enumerate(tt_.event_times_at_stop(
-                   r, static_cast<stop_idx_t>(stop_idx), ev_type))) {
+                   r, static_cast<stop_idx_t>(stop_idx), ev_type,
+                   event_times_buf))) {
             auto const [error, day_shift] =
                 mam_dist(vdv_mam, i32_minutes{nigiri_ev_time.mam()});
             auto const local_score =
@@ -236,8 +238,8 @@ std::optional<rt::run> updater::find_run(std::string_view vdv_run_id,
                 vdv_day_idx -
                     day_idx_t{nigiri_ev_time.days() + day_shift.count()}};
 
-            if (tt_.bitfields_[tt_.transport_traffic_days_[tr.t_idx_]].test(
-                    to_idx(tr.day_))) {
+            if (tt_.is_traffic_day(tt_.transport_traffic_days_[tr.t_idx_],
+                                   to_idx(tr.day_))) {
               auto candidate =
                   std::find_if(begin(candidates), end(candidates),
                                [&](auto const& c) { return c.r_.t_ == tr; });
@@ -1,16 +1,51 @@
 #include "nigiri/timetable.h"
 
+#include <atomic>
+#include <cassert>
+#include <fstream>
+#include <random>
+
+#include "cista/hash.h"
 #include "cista/io.h"
 
 #include "utl/overloaded.h"
+#include "utl/verify.h"
 
 #include "nigiri/common/day_list.h"
+#include "nigiri/common/page_advice.h"
+#include "nigiri/logging.h"
 #include "nigiri/rt/frun.h"
+#include "nigiri/timetable_window.h"
 
 namespace nigiri {
 
 constexpr auto const kMode = cista::mode::WITH_INTEGRITY;
 
+namespace {
+
+std::uint64_t trip_id_hash(source_idx_t const src,
+                           std::string_view const trip_id) {
+  return cista::hash(trip_id,
+                     cista::hash_combine(cista::BASE_HASH, to_idx(src)));
+}
+
+// One splitmix64 step: spreads seed and counter over all bits.
+std::uint64_t splitmix(std::uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31U);
+}
+
+}  // namespace
+
+std::uint64_t timetable::make_id() {
+  static auto const seed = std::random_device{}();
+  static auto counter = std::atomic_uint64_t{0U};
+  return splitmix((std::uint64_t{seed} << 32U) ^
+                  counter.fetch_add(1U, std::memory_order_relaxed));
+}
+
 std::string reverse(std::string s) {
   std::reverse(s.begin(), s.end());
   return s;
@@ -25,13 +60,62 @@ void timetable::locations::resolve_timezones() {
   }
 }
 
+void timetable::build_trip_id_index() {
+  auto const timer = scoped_timer{"timetable.build_trip_id_index"};
+
+  auto const same_id = [&](trip_id_idx_t const a, trip_id_idx_t const b) {
+    return trip_id_src_[a] == trip_id_src_[b] &&
+           trip_id_strings_[a].view() == trip_id_strings_[b].view();
+  };
+
+  auto entries = std::vector<std::pair<std::uint64_t, std::uint32_t>>{};
+  for (auto i = 0U; i != trip_id_to_idx_.size(); ++i) {
+    auto const id = trip_id_to_idx_[i].first;
+    if (i == 0U || !same_id(trip_id_to_idx_[i - 1U].first, id)) {
+      entries.emplace_back(
+          trip_id_hash(trip_id_src_[id], trip_id_strings_[id].view()), i);
+    }
+  }
+  if (!trip_id_index_.build(entries)) {
+    log(log_lvl::info, "timetable.build_trip_id_index",
+        "trip id hash collision, using binary search for trip ids");
+  }
+}
+
+vector<pair<trip_id_idx_t, trip_idx_t>>::const_iterator
+timetable::find_trip_id(source_idx_t const src,
+                        std::string_view const trip_id) const {
+  auto const matches = [&](pair<trip_id_idx_t, trip_idx_t> const& x) {
+    return trip_id_src_[x.first] == src &&
+           trip_id_strings_[x.first].view() == trip_id;
+  };
+
+  if (!trip_id_index_.empty()) {
+    auto const i = trip_id_index_.find(trip_id_hash(src, trip_id));
+    assert(i < trip_id_to_idx_.size() &&
+           "trip_id_to_idx_ changed after build_trip_id_index()");
+    auto const it = begin(trip_id_to_idx_) + i;
+    return matches(*it) ? it : end(trip_id_to_idx_);
+  }
+
+  auto const lb = std::lower_bound(
+      begin(trip_id_to_idx_), end(trip_id_to_idx_), trip_id,
+      [&](pair<trip_id_idx_t, trip_idx_t> const& a, std::string_view b) {
+        return std::tuple(trip_id_src_[a.first],
+                          trip_id_strings_[a.first].view()) <
+               std::tuple(src, b);
+      });
+  return lb != end(trip_id_to_idx_) && matches(*lb) ? lb
+                                                     : end(trip_id_to_idx_);
+}
+
 std::ostream& operator<<(std::ostream& out, timetable const& tt) {
   for (auto const [id, idx] : tt.trip_id_to_idx_) {
     auto const str = tt.trip_id_strings_[id].view();
     out << str << ":\n";
     for (auto const& t : tt.trip_transport_ranges_.at(idx)) {
       out << "  " << t.first << ": " << t.second << " active="
-          << day_list{tt.bitfields_[tt.transport_traffic_days_[t.first]],
+          << day_list{tt.traffic_days(tt.transport_traffic_days_[t.first]),
                       tt.internal_interval_days().from_}
           << "\n";
     }
@@ -45,7 +129,7 @@ std::ostream& operator<<(std::ostream& out, timetable const& tt) {
     auto const num_stops =
         tt.route_location_seq_[tt.transport_route_[transport_idx]].size();
     auto const traffic_days =
-        tt.bitfields_.at(tt.transport_traffic_days_.at(transport_idx));
+        tt.traffic_days(tt.transport_traffic_days_.at(transport_idx));
     out << "TRANSPORT=" << transport_idx << ", TRAFFIC_DAYS="
         << reverse(traffic_days.to_string().substr(kMaxDays - num_days))
         << "\n";
@@ -69,10 +153,68 @@ std::ostream& operator<<(std::ostream& out, timetable const& tt) {
   return out;
 }
 
+void timetable::advise_routing_data(timetable_read_options const& opt) const {
+  if (!opt.prefault_ && !opt.lock_) {
+    return;
+  }
+
+  auto prefaulted = std::size_t{0U};
+  auto locked = std::size_t{0U};
+  for_each_routing_section([&](void const* data, std::size_t const n) {
+    if (opt.prefault_ && prefault_pages(data, n)) {
+      prefaulted += n;
+    }
+    if (opt.lock_ && lock_pages(data, n)) {
+      locked += n;
+    }
+  });
+  log(log_lvl::info, "timetable.read",
+      "routing data: prefaulted {} MiB, locked {} MiB", prefaulted >> 20U,
+      locked >> 20U);
+}
+
 cista::wrapped<timetable> timetable::read(std::filesystem::path const& p) {
   return cista::read<timetable, kMode>(p);
 }
 
+cista::wrapped<timetable> timetable::read(std::filesystem::path const& p,
+                                          timetable_read_options const& opt) {
+  auto const timer = scoped_timer{"timetable.read"};
+
+  auto in = std::ifstream{p, std::ios_base::binary};
+  utl::verify(in.is_open(), "timetable.read: cannot open {}", p);
+  auto const size = std::filesystem::file_size(p);
+  auto b = cista::buffer{size};
+
+  // Has to happen before the pages are touched for the first time.
+  if (opt.huge_pages_ && !advise_huge_pages(b.data(), b.size())) {
+    log(log_lvl::info, "timetable.read", "huge pages not available");
+  }
+
+  in.read(reinterpret_cast<char*>(b.data()),
+          static_cast<std::streamsize>(size));
+  utl::verify(in.good(), "timetable.read: could not read {}", p);
+
+  auto const ptr = cista::deserialize<timetable, kMode>(b);
+  auto tt = cista::wrapped<timetable>{cista::memory_holder{std::move(b)}, ptr};
+
+  if (opt.date_window_.has_value()) {
+    auto copy = cista::raw::make_unique<timetable>(*tt);
+    restrict_to_window(*copy, *opt.date_window_);
+    tt = cista::wrapped<timetable>{std::move(copy)};
+  }
+
+  if (opt.prefault_) {
+    log(log_lvl::info, "timetable.read",
+        "prefault ignored: file was read into memory (use mapped_timetable)");
+  }
+  auto no_prefault = opt;
+  no_prefault.prefault_ = false;
+  tt->advise_routing_data(no_prefault);
+
+  return tt;
+}
+
 void timetable::write(std::filesystem::path const& p) const {
   return cista::write<kMode, timetable>(p, *this);
 }
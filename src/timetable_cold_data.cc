@@ -0,0 +1,87 @@
+#include "nigiri/timetable_cold_data.h"
+
+#include <utility>
+
+#include "cista/io.h"
+
+#include "utl/verify.h"
+
+#include "nigiri/logging.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri {
+
+namespace {
+
+constexpr auto const kMode = cista::mode::WITH_INTEGRITY;
+
+void swap_cold_data(timetable& tt, timetable_cold_data& cold) {
+  std::swap(tt.trip_debug_, cold.trip_debug_);
+  std::swap(tt.source_file_names_, cold.source_file_names_);
+  std::swap(tt.trip_display_names_, cold.trip_display_names_);
+}
+
+}  // namespace
+
+void write_hot_cold(timetable& tt,
+                    std::filesystem::path const& hot,
+                    std::filesystem::path const& cold) {
+  auto const timer = scoped_timer{"timetable.write_hot_cold"};
+
+  auto cold_data = timetable_cold_data{};
+  swap_cold_data(tt, cold_data);
+  try {
+    tt.write(hot);
+    cista::write<kMode, timetable_cold_data>(cold, cold_data);
+  } catch (...) {
+    swap_cold_data(tt, cold_data);
+    throw;
+  }
+  swap_cold_data(tt, cold_data);
+}
+
+lazy_cold_data::lazy_cold_data(std::filesystem::path p, timetable const& tt)
+    : path_{std::move(p)}, tt_{tt} {}
+
+timetable_cold_data const& lazy_cold_data::get() const {
+  std::call_once(once_, [&]() {
+    auto const timer = scoped_timer{"timetable.read_cold_data"};
+    auto data = cista::read<timetable_cold_data, kMode>(path_);
+    utl::verify(data->trip_display_names_.size() == tt_.trip_ids_.size(),
+                "cold data: {} trip display names, timetable has {} trips",
+                data->trip_display_names_.size(), tt_.trip_ids_.size());
+    data_.emplace(std::move(data));
+    loaded_.store(true, std::memory_order_release);
+  });
+  return **data_;
+}
+
+std::string_view lazy_cold_data::trip_display_name(
+    trip_idx_t const trip_idx) const {
+  return get().trip_display_names_[trip_idx].view();
+}
+
+std::string_view lazy_cold_data::transport_name(
+    transport_idx_t const t) const {
+  return trip_display_name(
+      tt_.merged_trips_[tt_.transport_to_trip_section_[t].front()].front());
+}
+
+debug lazy_cold_data::dbg(transport_idx_t const t) const {
+  auto const& cold = get();
+  auto const trip_idx =
+      tt_.merged_trips_[tt_.transport_to_trip_section_[t].front()].front();
+  if (to_idx(trip_idx) >= cold.trip_debug_.size() ||
+      cold.trip_debug_[trip_idx].empty()) {
+    return debug{};
+  }
+  auto const& d = cold.trip_debug_[trip_idx].front();
+  return debug{cold.source_file_names_[d.source_file_idx_].view(),
+               d.line_number_from_, d.line_number_to_};
+}
+
+bool lazy_cold_data::is_loaded() const {
+  return loaded_.load(std::memory_order_acquire);
+}
+
+}  // namespace nigiri
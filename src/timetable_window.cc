@@ -0,0 +1,177 @@
+#include "nigiri/timetable_window.h"
+
+#include <vector>
+
+#include "utl/get_or_create.h"
+#include "utl/verify.h"
+
+#include "nigiri/loader/build_frequency_runs.h"
+#include "nigiri/logging.h"
+#include "nigiri/timetable.h"
+
+namespace nigiri {
+
+namespace {
+
+template <typename Vec>
+void filter_transports(Vec& v, std::vector<bool> const& keep) {
+  if (v.size() != keep.size()) {
+    return;
+  }
+  auto filtered = Vec{};
+  for (auto i = 0U; i != keep.size(); ++i) {
+    if (keep[i]) {
+      filtered.emplace_back(v[transport_idx_t{i}]);
+    }
+  }
+  v = std::move(filtered);
+}
+
+}  // namespace
+
+void restrict_to_window(timetable& tt, interval<date::sys_days> const window) {
+  auto const timer = scoped_timer{"timetable.restrict_to_window"};
+
+  utl::verify(!tt.has_compressed_stop_times(),
+              "restrict_to_window: stop times are compressed");
+  utl::verify(!tt.has_compressed_bitfields(),
+              "restrict_to_window: bitfields are compressed");
+
+  utl::verify(tt.date_range_.from_ <= window.from_ &&
+                  window.from_ < window.to_ &&
+                  window.to_ <= tt.date_range_.to_,
+              "restrict_to_window: window [{}, {}) not in date range [{}, {})",
+              date::format("%F", window.from_), date::format("%F", window.to_),
+              date::format("%F", tt.date_range_.from_),
+              date::format("%F", tt.date_range_.to_));
+
+  // Bits [0, n_days) of the new bitfields cover the new internal interval.
+  auto const shift =
+      static_cast<std::size_t>((window.from_ - tt.date_range_.from_).count());
+  auto const n_days = static_cast<std::size_t>(
+      (window.to_ + date::days{1} - (window.from_ - kTimetableOffset))
+          .count());
+  auto mask = bitfield{};
+  for (auto i = 0U; i != n_days && i != kMaxDays; ++i) {
+    mask.set(i, true);
+  }
+
+  // Bitfields.
+  auto bitfields = vector_map<bitfield_idx_t, bitfield>{};
+  auto bitfield_indices = hash_map<bitfield, bitfield_idx_t>{};
+  auto new_bitfield_idx = vector_map<bitfield_idx_t, bitfield_idx_t>{};
+  new_bitfield_idx.resize(tt.bitfields_.size());
+  for (auto i = bitfield_idx_t{0U}; i != tt.bitfields_.size(); ++i) {
+    auto const bf = (tt.bitfields_[i] >> shift) & mask;
+    new_bitfield_idx[i] = utl::get_or_create(bitfield_indices, bf, [&]() {
+      auto const idx = bitfield_idx_t{bitfields.size()};
+      bitfields.emplace_back(bf);
+      return idx;
+    });
+  }
+
+  // Transports.
+  auto const n_transports = tt.transport_traffic_days_.size();
+  auto keep = std::vector<bool>(n_transports);
+  auto new_transport_idx = vector_map<transport_idx_t, transport_idx_t>{};
+  new_transport_idx.resize(n_transports + 1U);
+  auto n_kept = transport_idx_t::value_t{0U};
+  for (auto t = transport_idx_t{0U}; t != n_transports; ++t) {
+    new_transport_idx[t] = transport_idx_t{n_kept};
+    keep[to_idx(t)] =
+        bitfields[new_bitfield_idx[tt.transport_traffic_days_[t]]].any();
+    n_kept += keep[to_idx(t)] ? 1U : 0U;
+  }
+  new_transport_idx.back() = transport_idx_t{n_kept};
+
+  // Route -> transports + stop times (all transports of a route per stop).
+  auto stop_times = vector<delta>{};
+  auto stop_time_ranges = vector_map<route_idx_t, interval<std::uint32_t>>{};
+  for (auto r = route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const transports = tt.route_transport_ranges_[r];
+    auto const n = static_cast<std::uint32_t>(transports.size());
+    auto const range = tt.route_stop_time_ranges_[r];
+    auto const from = static_cast<std::uint32_t>(stop_times.size());
+    for (auto i = range.from_; i != range.to_; ++i) {
+      if (keep[to_idx(transports.from_) + (i - range.from_) % n]) {
+        stop_times.push_back(tt.route_stop_times_[i]);
+      }
+    }
+    stop_time_ranges.push_back(interval<std::uint32_t>{
+        from, static_cast<std::uint32_t>(stop_times.size())});
+    tt.route_transport_ranges_[r] = {new_transport_idx[transports.from_],
+                                     new_transport_idx[transports.to_]};
+  }
+  tt.route_stop_times_ = std::move(stop_times);
+  tt.route_stop_time_ranges_ = std::move(stop_time_ranges);
+
+  auto location_routes = vecvec<location_idx_t, route_idx_t>{};
+  auto routes = std::vector<route_idx_t>{};
+  for (auto const l_routes : tt.location_routes_) {
+    routes.clear();
+    for (auto const r : l_routes) {
+      auto const transports = tt.route_transport_ranges_[r];
+      if (transports.from_ != transports.to_) {
+        routes.emplace_back(r);
+      }
+    }
+    location_routes.emplace_back(routes);
+  }
+  tt.location_routes_ = std::move(location_routes);
+
+  // Transport-indexed data.
+  for (auto& bf : tt.transport_traffic_days_) {
+    bf = new_bitfield_idx[bf];
+  }
+  filter_transports(tt.transport_first_dep_offset_, keep);
+  filter_transports(tt.initial_day_offset_, keep);
+  filter_transports(tt.transport_traffic_days_, keep);
+  filter_transports(tt.transport_route_, keep);
+  filter_transports(tt.transport_to_trip_section_, keep);
+  filter_transports(tt.transport_section_attributes_, keep);
+  filter_transports(tt.transport_section_providers_, keep);
+  filter_transports(tt.transport_section_directions_, keep);
+  filter_transports(tt.transport_section_lines_, keep);
+  filter_transports(tt.transport_section_route_colors_, keep);
+
+  // Trip -> transports.
+  auto trip_transport_ranges = paged_vecvec<trip_idx_t, transport_range_t>{};
+  auto ranges = std::vector<transport_range_t>{};
+  for (auto const trip_ranges : tt.trip_transport_ranges_) {
+    ranges.clear();
+    for (auto const& [t, stop_range] : trip_ranges) {
+      if (keep[to_idx(t)]) {
+        ranges.push_back(transport_range_t{new_transport_idx[t], stop_range});
+      }
+    }
+    trip_transport_ranges.emplace_back(ranges);
+  }
+  tt.trip_transport_ranges_ = std::move(trip_transport_ranges);
+
+  // Flex trips (only days change).
+  for (auto& bf : tt.trip_service_) {
+    if (bf != bitfield_idx_t::invalid()) {
+      bf = new_bitfield_idx[bf];
+    }
+  }
+  for (auto& rule : tt.booking_rules_) {
+    if (rule.bitfield_idx_ != bitfield_idx_t::invalid()) {
+      rule.bitfield_idx_ = new_bitfield_idx[rule.bitfield_idx_];
+    }
+  }
+
+  log(log_lvl::info, "timetable.restrict_to_window",
+      "{} of {} transports, {} of {} bitfields", n_kept, n_transports,
+      bitfields.size(), tt.bitfields_.size());
+
+  tt.bitfields_ = std::move(bitfields);
+  tt.date_range_ = window;
+
+  if (tt.route_frequency_runs_.size() != 0U) {
+    loader::build_frequency_runs(tt);
+  }
+
+  tt.renew_id();
+}
+
+}  // namespace nigiri
@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/common/compressed_bitfield.h"
+
+using namespace nigiri;
+
+TEST(compressed_bitfield, empty) {
+  auto const c = compressed_bitfield::compress(bitfield{});
+  EXPECT_TRUE(c.empty());
+  EXPECT_FALSE(c.test(0U));
+  EXPECT_EQ(bitfield{}, c.decompress());
+}
+
+TEST(compressed_bitfield, weekdays_with_exceptions) {
+  auto bf = bitfield{};
+  for (auto i = 10U; i != 375U; ++i) {
+    if (i % 7U != 5U && i % 7U != 6U) {
+      bf.set(i);
+    }
+  }
+  bf.set(42U, false);
+  bf.set(43U, false);
+  bf.set(48U, true);
+
+  auto const c = compressed_bitfield::compress(bf);
+  EXPECT_EQ(10U, c.from_);
+  EXPECT_EQ(375U, c.to_);
+  EXPECT_EQ(0b0011111U, c.weekdays_);
+  EXPECT_EQ(3U, c.exceptions_.size());
+  EXPECT_LT(c.size_bytes(), sizeof(bitfield));
+  EXPECT_EQ(bf, c.decompress());
+  EXPECT_EQ(bf.count(), c.count());
+  for (auto i = 0U; i != kMaxDays; ++i) {
+    EXPECT_EQ(bf.test(i), c.test(i)) << "day " << i;
+  }
+}
+
+TEST(compressed_bitfield, irregular) {
+  auto bf = bitfield{};
+  for (auto const d : {3U, 17U, 18U, 200U, 511U}) {
+    bf.set(d);
+  }
+
+  auto const c = compressed_bitfield::compress(bf);
+  EXPECT_EQ(bf, c.decompress());
+  for (auto i = 0U; i != kMaxDays; ++i) {
+    EXPECT_EQ(bf.test(i), c.test(i)) << "day " << i;
+  }
+}
@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "nigiri/common/event_time_search.h"
+#include "nigiri/common/linear_lower_bound.h"
+
+using namespace nigiri;
+
+namespace {
+
+template <direction SearchDir>
+std::size_t reference(std::vector<delta> const& events, std::int16_t const key) {
+  if constexpr (SearchDir == direction::kForward) {
+    return static_cast<std::size_t>(
+        linear_lb(begin(events), end(events), key,
+                  [](delta const a, std::int16_t const b) {
+                    return a.mam() < b;
+                  }) -
+        begin(events));
+  } else {
+    return static_cast<std::size_t>(
+        linear_lb(events.rbegin(), events.rend(), key,
+                  [](delta const a, std::int16_t const b) {
+                    return a.mam() > b;
+                  }) -
+        events.rbegin());
+  }
+}
+
+}  // namespace
+
+TEST(event_time_search, delta_layout) {
+  auto const d = delta{3U, 1234U};
+  EXPECT_EQ(1234U, d.value() >> 5U);
+}
+
+TEST(event_time_search, matches_linear_lb) {
+  auto rng = std::mt19937{42U};
+  auto day_dist = std::uniform_int_distribution<std::uint16_t>{0U, 3U};
+  auto mam_dist = std::uniform_int_distribution<std::uint16_t>{0U, 1439U};
+  auto key_dist = std::uniform_int_distribution<std::int16_t>{0, 1439};
+
+  for (auto n = 0U; n != 70U; ++n) {
+    auto events = std::vector<delta>{};
+    for (auto i = 0U; i != n; ++i) {
+      events.emplace_back(day_dist(rng), mam_dist(rng));
+    }
+    for (auto const key :
+         {std::int16_t{0}, std::int16_t{1439}, key_dist(rng), key_dist(rng)}) {
+      EXPECT_EQ(reference<direction::kForward>(events, key),
+                n_unreachable_events<direction::kForward>(events, key));
+      EXPECT_EQ(reference<direction::kBackward>(events, key),
+                n_unreachable_events<direction::kBackward>(events, key));
+    }
+  }
+}
+
+TEST(event_time_search, frequency_runs) {
+  auto rng = std::mt19937{42U};
+  auto start_dist = std::uniform_int_distribution<unsigned>{0U, 3U * 1440U};
+  auto headway_dist = std::uniform_int_distribution<unsigned>{1U, 200U};
+  auto length_dist = std::uniform_int_distribution<unsigned>{1U, 60U};
+  auto key_dist = std::uniform_int_distribution<std::int16_t>{0, 1439};
+
+  for (auto run = 0U; run != 50U; ++run) {
+    auto events = std::vector<delta>{};
+    auto runs = std::vector<frequency_run>{};
+    for (auto i = 0U; i != 1U + run % 5U; ++i) {
+      auto const start = start_dist(rng);
+      auto const headway = headway_dist(rng);
+      auto const n = length_dist(rng);
+      runs.push_back({.from_ = static_cast<std::uint32_t>(events.size()),
+                      .n_ = n,
+                      .headway_ = static_cast<std::uint16_t>(headway)});
+      for (auto j = 0U; j != n; ++j) {
+        events.emplace_back(static_cast<std::uint16_t>(start + j * headway));
+      }
+    }
+
+    for (auto const key :
+         {std::int16_t{0}, std::int16_t{1439}, key_dist(rng), key_dist(rng)}) {
+      EXPECT_EQ(n_unreachable_events<direction::kForward>(events, key),
+                n_unreachable_events<direction::kForward>(events, runs, key));
+      EXPECT_EQ(n_unreachable_events<direction::kBackward>(events, key),
+                n_unreachable_events<direction::kBackward>(events, runs, key));
+
+      // Events on demand: at most the first event of each run is read.
+      auto n_reads = std::size_t{0U};
+      auto const event_at = [&](std::size_t const i) {
+        ++n_reads;
+        return events[i];
+      };
+      EXPECT_EQ(n_unreachable_events<direction::kForward>(events, key),
+                n_unreachable_events<direction::kForward>(
+                    events.size(), runs, key, event_at));
+      EXPECT_LE(n_reads, runs.size());
+    }
+  }
+}
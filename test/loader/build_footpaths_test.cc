@@ -2,6 +2,7 @@
 
 #include "utl/enumerate.h"
 
+#include "nigiri/loader/build_footpaths.h"
 #include "nigiri/loader/gtfs/files.h"
 #include "nigiri/loader/gtfs/load_timetable.h"
 #include "nigiri/loader/init_finish.h"
@@ -73,4 +74,58 @@ TEST(loader, build_footpaths) {
   00:06.0->(A, A)
 )"sv,
             ss.str());
-}
\ No newline at end of file
+}
+TEST(loader, deduplicate_footpath_profiles) {
+  auto tt = timetable{};
+
+  tt.date_range_ = {date::sys_days{2024_y / March / 1},
+                    date::sys_days{2024_y / March / 2}};
+  loader::register_special_stations(tt);
+  loader::gtfs::load_timetable({}, source_idx_t{0},
+                               loader::mem_dir::read(test_files), tt);
+  loader::finalize(tt);
+
+  constexpr auto const kProfile = profile_idx_t{1U};
+  auto const src = source_idx_t{0};
+  auto const B = tt.locations_.location_id_to_idx_.at({"B", src});
+  auto const C = tt.locations_.location_id_to_idx_.at({"C", src});
+
+  // Profile 1 = profile 0, except for B (only a slow footpath to C).
+  auto& loc = tt.locations_;
+  for (auto l = location_idx_t{0U}; l != tt.n_locations(); ++l) {
+    if (l == B) {
+      loc.footpaths_out_[kProfile].emplace_back(
+          std::initializer_list<footpath>{footpath{C, 10min}});
+    } else {
+      loc.footpaths_out_[kProfile].emplace_back(loc.footpaths_out_[0][l]);
+    }
+    loc.footpaths_in_[kProfile].emplace_back(loc.footpaths_in_[0][l]);
+  }
+
+  auto expected_out = std::vector<std::vector<footpath>>{};
+  for (auto l = location_idx_t{0U}; l != tt.n_locations(); ++l) {
+    auto const fps = loc.footpaths_out(kProfile, l);
+    expected_out.emplace_back(begin(fps), end(fps));
+  }
+
+  loader::deduplicate_footpath_profiles(tt);
+
+  ASSERT_EQ(tt.n_locations(), loc.has_own_footpaths_out_[kProfile].size());
+  ASSERT_EQ(tt.n_locations(), loc.has_own_footpaths_in_[kProfile].size());
+  EXPECT_EQ(1U, loc.footpaths_out_[kProfile].data_.size());
+  EXPECT_EQ(0U, loc.footpaths_in_[kProfile].data_.size());
+  EXPECT_EQ(0U, loc.has_own_footpaths_out_[0U].size());
+
+  for (auto l = location_idx_t{0U}; l != tt.n_locations(); ++l) {
+    EXPECT_EQ(l == B, loc.has_own_footpaths_out_[kProfile].test(l));
+    EXPECT_FALSE(loc.has_own_footpaths_in_[kProfile].test(l));
+
+    auto const out = loc.footpaths_out(kProfile, l);
+    EXPECT_EQ(expected_out[to_idx(l)],
+              std::vector<footpath>(begin(out), end(out)));
+
+    auto const in = loc.footpaths_in(kProfile, l);
+    auto const base_in = loc.footpaths_in_[0][l];
+    EXPECT_TRUE(std::equal(begin(in), end(in), begin(base_in), end(base_in)));
+  }
+}
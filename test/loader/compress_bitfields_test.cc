@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+
+#include "../raptor_search.h"
+#include "hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::hrd;
+using namespace nigiri::test_data::hrd_timetable;
+
+namespace {
+
+std::string search(timetable const& tt) {
+  auto const results = nigiri::test::raptor_search(
+      tt, nullptr, "0000001", "0000003",
+      interval{unixtime_t{sys_days{2020_y / March / 30}} + 5_hours,
+               unixtime_t{sys_days{2020_y / March / 30}} + 6_hours});
+  std::stringstream ss;
+  for (auto const& x : results) {
+    x.print(ss, tt);
+  }
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(loader, compress_bitfields) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto compressed = timetable{};
+  compressed.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), compressed);
+  finalize(compressed, finalize_options{.compress_bitfields_ = true});
+
+  ASSERT_TRUE(compressed.has_compressed_bitfields());
+  EXPECT_EQ(0U, compressed.bitfields_.size());
+  EXPECT_LE(compressed.n_bitfields(), tt.n_bitfields());
+  EXPECT_LT(compressed.compressed_bitfields_.size_bytes(),
+            tt.bitfields_.size() * sizeof(bitfield));
+
+  ASSERT_EQ(tt.transport_traffic_days_.size(),
+            compressed.transport_traffic_days_.size());
+  for (auto t = transport_idx_t{0U}; t != tt.transport_traffic_days_.size();
+       ++t) {
+    auto const expected = tt.traffic_days(tt.transport_traffic_days_[t]);
+    auto const bf_idx = compressed.transport_traffic_days_[t];
+    EXPECT_EQ(expected, compressed.traffic_days(bf_idx));
+    for (auto day = 0U; day != kMaxDays; ++day) {
+      EXPECT_EQ(expected.test(day), compressed.is_traffic_day(bf_idx, day));
+    }
+  }
+
+  EXPECT_EQ(search(tt), search(compressed));
+}
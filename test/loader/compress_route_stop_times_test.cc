@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "utl/enumerate.h"
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+
+#include "../raptor_search.h"
+#include "hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::hrd;
+using namespace nigiri::test_data::hrd_timetable;
+
+namespace {
+
+std::string search(timetable const& tt) {
+  auto const results = nigiri::test::raptor_search(
+      tt, nullptr, "0000001", "0000003",
+      interval{unixtime_t{sys_days{2020_y / March / 30}} + 5_hours,
+               unixtime_t{sys_days{2020_y / March / 30}} + 6_hours});
+  std::stringstream ss;
+  for (auto const& x : results) {
+    x.print(ss, tt);
+  }
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(loader, compress_route_stop_times) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto compressed = timetable{};
+  compressed.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), compressed);
+  finalize(compressed, finalize_options{.compress_route_stop_times_ = true});
+
+  ASSERT_TRUE(compressed.has_compressed_stop_times());
+  EXPECT_EQ(0U, compressed.route_stop_times_.size());
+
+  auto expected_buf = std::vector<delta>{};
+  auto actual_buf = std::vector<delta>{};
+  for (auto r = route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const n_stops =
+        static_cast<stop_idx_t>(tt.route_location_seq_[r].size());
+    for (auto i = stop_idx_t{0U}; i != n_stops; ++i) {
+      for (auto const ev : {event_type::kArr, event_type::kDep}) {
+        if ((i == 0U && ev == event_type::kArr) ||
+            (i == n_stops - 1U && ev == event_type::kDep)) {
+          continue;
+        }
+
+        auto const expected = tt.event_times_at_stop(r, i, ev, expected_buf);
+        auto const actual =
+            compressed.event_times_at_stop(r, i, ev, actual_buf);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (auto j = 0U; j != expected.size(); ++j) {
+          EXPECT_EQ(expected[j], actual[j]);
+        }
+
+        for (auto const t : tt.route_transport_ranges_[r]) {
+          EXPECT_EQ(tt.event_mam(t, i, ev), compressed.event_mam(t, i, ev));
+        }
+      }
+    }
+  }
+
+  // Spans decoded into different buffers stay valid at the same time.
+  auto dep_buf = std::vector<delta>{};
+  auto arr_buf = std::vector<delta>{};
+  for (auto r = route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const dep =
+        compressed.event_times_at_stop(r, 0U, event_type::kDep, dep_buf);
+    auto const arr =
+        compressed.event_times_at_stop(r, 1U, event_type::kArr, arr_buf);
+    ASSERT_EQ(dep.size(), arr.size());
+    for (auto const [j, t] : utl::enumerate(tt.route_transport_ranges_[r])) {
+      EXPECT_EQ(tt.event_mam(t, 0U, event_type::kDep), dep[j]);
+      EXPECT_EQ(tt.event_mam(t, 1U, event_type::kArr), arr[j]);
+    }
+  }
+
+  EXPECT_EQ(search(tt), search(compressed));
+}
@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "nigiri/loader/dir.h"
+#include "nigiri/loader/gtfs/agency.h"
+#include "nigiri/loader/gtfs/calendar.h"
+#include "nigiri/loader/gtfs/calendar_date.h"
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/local_to_utc.h"
+#include "nigiri/loader/gtfs/noon_offsets.h"
+#include "nigiri/loader/gtfs/route.h"
+#include "nigiri/loader/gtfs/services.h"
+#include "nigiri/loader/gtfs/stop.h"
+#include "nigiri/loader/gtfs/stop_time.h"
+#include "nigiri/loader/gtfs/trip.h"
+#include "nigiri/loader/loader_interface.h"
+#include "nigiri/timetable.h"
+
+using namespace date;
+
+namespace nigiri::loader::gtfs {
+
+namespace {
+
+// T1 and T2 share timezone, first departure, last arrival and service
+// (= the same utc_conversion_signature) but differ in the time at S2.
+// Service spans the switch to summer time on March 31: in winter, 01:30
+// local is 00:30 UTC on the same day, in summer 23:30 UTC the day before.
+mem_dir dst_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DTA,Demo Transit Authority,,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+S1,S1,50.0,8.0
+S2,S2,50.1,8.1
+S3,S3,50.2,8.2
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+R1,DTA,R1,,3
+
+# trips.txt
+route_id,service_id,trip_id
+R1,S,T1
+R1,S,T2
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+T1,01:30:00,01:30:00,S1,1
+T1,02:00:00,02:00:00,S2,2
+T1,02:30:00,02:30:00,S3,3
+T2,01:30:00,01:30:00,S1,1
+T2,02:10:00,02:10:00,S2,2
+T2,02:30:00,02:30:00,S3,3
+
+# calendar.txt
+service_id,monday,tuesday,wednesday,thursday,friday,saturday,sunday,start_date,end_date
+S,1,1,1,1,1,1,1,20190325,20190406
+)");
+}
+
+std::vector<utc_trip> expand(trip_data const& trips,
+                             noon_offset_hours_t const& noon_offsets,
+                             timetable const& tt,
+                             std::string_view trip_id,
+                             local_to_utc_cache& cache) {
+  auto const t = trips.trips_.at(trip_id);
+  auto ret = std::vector<utc_trip>{};
+  expand_local_to_utc(
+      trips, noon_offsets, tt,
+      frequency_expanded_trip{
+          .trips_ = std::basic_string<gtfs_trip_idx_t>{t},
+          .offsets_ = std::basic_string<duration_t>{duration_t{0}},
+          .traffic_days_ = trips.get(t).service_},
+      tt.date_range_, cache,
+      [&](utc_trip&& x) { ret.emplace_back(std::move(x)); });
+  std::sort(begin(ret), end(ret), [](utc_trip const& a, utc_trip const& b) {
+    return a.first_dep_offset_ < b.first_dep_offset_;
+  });
+  return ret;
+}
+
+void expect_eq(std::vector<utc_trip> const& a,
+               std::vector<utc_trip> const& b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (auto i = 0U; i != a.size(); ++i) {
+    EXPECT_EQ(a[i].first_dep_offset_, b[i].first_dep_offset_);
+    EXPECT_TRUE(a[i].utc_times_ == b[i].utc_times_);
+    EXPECT_TRUE(a[i].utc_traffic_days_ == b[i].utc_traffic_days_);
+  }
+}
+
+}  // namespace
+
+TEST(gtfs, local_to_utc_cache) {
+  auto const files = dst_files();
+
+  auto tt = timetable{};
+  tt.date_range_ = interval{sys_days{March / 25 / 2019},
+                            sys_days{April / 7 / 2019}};
+
+  auto const config = loader_config{};
+  auto timezones = tz_map{};
+  auto agencies =
+      read_agencies(tt, timezones, files.get_file(kAgencyFile).data());
+  auto const stops = read_stops(source_idx_t{0}, tt, timezones,
+                                files.get_file(kStopFile).data(), "", 0U);
+  auto const routes = read_routes(tt, timezones, agencies,
+                                  files.get_file(kRoutesFile).data(), "CET");
+  auto const calendar = read_calendar(files.get_file(kCalenderFile).data());
+  auto const services = merge_traffic_days(tt.internal_interval_days(),
+                                           calendar, {});
+  auto trips =
+      read_trips(tt, routes, services, {}, files.get_file(kTripsFile).data(),
+                 config.bikes_allowed_default_);
+  read_stop_times(tt, trips, stops, files.get_file(kStopTimesFile).data(),
+                  false);
+  auto const noon_offsets = precompute_noon_offsets(tt, agencies);
+
+  auto cache = local_to_utc_cache{};
+  auto const t1 = expand(trips, noon_offsets, tt, "T1", cache);
+  auto const t2 = expand(trips, noon_offsets, tt, "T2", cache);
+  EXPECT_EQ(1U, cache.size());
+
+  // Cached partitions give the same result as computing them per trip.
+  auto t1_cache = local_to_utc_cache{};
+  auto t2_cache = local_to_utc_cache{};
+  expect_eq(expand(trips, noon_offsets, tt, "T1", t1_cache), t1);
+  expect_eq(expand(trips, noon_offsets, tt, "T2", t2_cache), t2);
+
+  // Summer (UTC+2, day before) and winter (UTC+1, same day) partitions.
+  ASSERT_EQ(2U, t2.size());
+  EXPECT_EQ(duration_t{-1440 + 120}, t2[0].first_dep_offset_);
+  EXPECT_EQ(duration_t{60}, t2[1].first_dep_offset_);
+  EXPECT_EQ(13U, t2[0].utc_traffic_days_.count() +
+                     t2[1].utc_traffic_days_.count());
+  EXPECT_EQ(7U, t2[0].utc_traffic_days_.count());
+
+  // Stop times are not shared between trips with the same signature.
+  ASSERT_EQ(t1.size(), t2.size());
+  EXPECT_EQ(duration_t{60}, t1[1].utc_times_[1]);
+  EXPECT_EQ(duration_t{70}, t2[1].utc_times_[1]);
+}
+
+}  // namespace nigiri::loader::gtfs
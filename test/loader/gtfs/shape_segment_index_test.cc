@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "geo/polyline.h"
+
+#include "nigiri/loader/gtfs/shape_segment_index.h"
+
+using namespace nigiri::loader::gtfs;
+
+namespace {
+
+double normalize_lng(double lng) {
+  while (lng >= 180.0) {
+    lng -= 360.0;
+  }
+  while (lng < -180.0) {
+    lng += 360.0;
+  }
+  return lng;
+}
+
+std::vector<geo::latlng> random_shape(std::mt19937& rng,
+                                      geo::latlng const& start,
+                                      double const step,
+                                      std::size_t const n) {
+  auto d = std::uniform_real_distribution<double>{-step, step};
+  auto shape = std::vector<geo::latlng>{start};
+  while (shape.size() != n) {
+    auto const& p = shape.back();
+    shape.push_back({std::clamp(p.lat_ + d(rng), -89.9, 89.9),
+                     normalize_lng(p.lng_ + d(rng))});
+  }
+  return shape;
+}
+
+std::size_t linear_closest(std::vector<geo::latlng> const& shape,
+                           geo::latlng const& pos,
+                           std::size_t const from,
+                           std::size_t const to) {
+  if (to - from < 2U) {
+    return from;
+  }
+  auto const best = geo::distance_to_polyline(
+      pos, std::span<geo::latlng const>{shape}.subspan(from, to - from));
+  auto const segment = from + best.segment_idx_;
+  return geo::distance(pos, shape[segment]) <=
+                 geo::distance(pos, shape[segment + 1U])
+             ? segment
+             : segment + 1U;
+}
+
+}  // namespace
+
+TEST(shape_segment_index, matches_linear_scan) {
+  auto rng = std::mt19937{7U};
+  struct area {
+    geo::latlng start_;
+    double step_;
+  };
+  for (auto const& [start, step] : {
+           area{{49.87, 8.65}, 0.01},  // mid latitude
+           area{{49.87, 8.65}, 2.0},  // long segments
+           area{{78.22, 15.65}, 0.5},  // high latitude
+           area{{89.0, 0.0}, 5.0},  // around the pole
+           area{{-85.0, 120.0}, 5.0},  // south pole
+           area{{-17.8, 179.9}, 0.05},  // antimeridian
+           area{{65.0, -179.5}, 3.0}  // antimeridian, high latitude
+       }) {
+    auto const shape = random_shape(rng, start, step, 500U);
+    auto const index = shape_segment_index{shape};
+
+    auto pos_d = std::uniform_real_distribution<double>{-10.0 * step,
+                                                        10.0 * step};
+    auto idx_d = std::uniform_int_distribution<std::size_t>{0U, shape.size()};
+    for (auto i = 0U; i != 2000U; ++i) {
+      auto const& anchor = shape[idx_d(rng) % shape.size()];
+      auto const pos =
+          geo::latlng{std::clamp(anchor.lat_ + pos_d(rng), -90.0, 90.0),
+                      normalize_lng(anchor.lng_ + pos_d(rng))};
+      auto from = idx_d(rng);
+      auto to = idx_d(rng);
+      if (from > to) {
+        std::swap(from, to);
+      }
+      if (from == shape.size()) {
+        continue;
+      }
+      EXPECT_EQ(linear_closest(shape, pos, from, to),
+                index.get_closest(pos, from, to))
+          << "start=" << start << ", pos=" << pos << ", from=" << from
+          << ", to=" << to;
+    }
+
+    for (auto const& b : index.block_bboxes_) {
+      for (auto j = 0U; j != 100U; ++j) {
+        auto const& anchor = shape[idx_d(rng) % shape.size()];
+        auto const pos =
+            geo::latlng{std::clamp(anchor.lat_ + pos_d(rng), -90.0, 90.0),
+                        normalize_lng(anchor.lng_ + pos_d(rng))};
+        auto const corner = geo::latlng{b.min_.lat_, b.min_.lng_};
+        EXPECT_LE(shape_segment_index::min_distance(pos, b),
+                  geo::distance(pos, corner));
+      }
+    }
+  }
+}
@@ -2,8 +2,11 @@
 
 #include <iostream>
 #include <set>
+#include <sstream>
+#include <vector>
 
 #include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/hrd/service/read_services.h"
 
 #include "../service_strings.h"
 #include "./hrd_timetable.h"
@@ -127,3 +130,41 @@ TEST(hrd, services_to_string_test) {
 
   EXPECT_EQ(expected, service_strings(tt));
 }
+
+TEST(hrd, parallel_service_expansion) {
+  auto const expand = [](bool const parallel) {
+    auto const d = files();
+    auto tt = timetable{};
+    tt.date_range_ = full_period();
+    auto st = stamm{hrd_5_20_26, tt, d};
+    auto store = service_store{};
+    auto ret = std::vector<std::string>{};
+    for (auto const& path : d.list_files(hrd_5_20_26.fplan_)) {
+      auto const file = d.get_file(path);
+      parse_services(
+          hrd_5_20_26, path.generic_string().c_str(), source_file_idx_t{0U},
+          st.get_date_range(), tt.date_range_, store, st, file.data(),
+          [](std::size_t) {},
+          [&](ref_service&& s) {
+            auto ss = std::stringstream{};
+            ss << s.ref_ << " " << s.repetition_ << " "
+               << s.split_info_.sections_ << " "
+               << s.split_info_.traffic_days_.to_string() << " "
+               << s.utc_traffic_days_.to_string();
+            for (auto const t : s.utc_times_) {
+              ss << " " << t.count();
+            }
+            for (auto const x : s.stop_seq_) {
+              ss << " " << x;
+            }
+            ret.emplace_back(ss.str());
+          },
+          parallel);
+    }
+    return ret;
+  };
+
+  auto const sequential = expand(false);
+  EXPECT_FALSE(sequential.empty());
+  EXPECT_EQ(sequential, expand(true));
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/loader/reorder_routes.h"
+
+#include "../raptor_search.h"
+#include "hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::hrd;
+using namespace nigiri::test_data::hrd_timetable;
+
+namespace {
+
+std::string search(timetable const& tt) {
+  auto const results = nigiri::test::raptor_search(
+      tt, nullptr, "0000001", "0000003",
+      interval{unixtime_t{sys_days{2020_y / March / 30}} + 5_hours,
+               unixtime_t{sys_days{2020_y / March / 30}} + 6_hours});
+  std::stringstream ss;
+  for (auto const& x : results) {
+    x.print(ss, tt);
+  }
+  return ss.str();
+}
+
+}  // namespace
+
+TEST(loader, reorder_routes) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto reordered = timetable{};
+  reordered.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), reordered);
+  finalize(reordered, finalize_options{.reorder_routes_ = true});
+
+  ASSERT_EQ(tt.n_routes(), reordered.n_routes());
+  ASSERT_EQ(tt.route_stop_times_.size(), reordered.route_stop_times_.size());
+
+  // Same transports, consistently referencing their (new) route.
+  for (auto r = route_idx_t{0U}; r != reordered.n_routes(); ++r) {
+    for (auto const t : reordered.route_transport_ranges_[r]) {
+      EXPECT_EQ(r, reordered.transport_route_[t]);
+      EXPECT_EQ(tt.route_location_seq_[tt.transport_route_[t]].size(),
+                reordered.route_location_seq_[r].size());
+      auto const n_stops = reordered.route_location_seq_[r].size();
+      for (auto i = stop_idx_t{1U}; i != n_stops; ++i) {
+        EXPECT_EQ(tt.event_mam(t, i, event_type::kArr).count(),
+                  reordered.event_mam(t, i, event_type::kArr).count());
+      }
+    }
+    for (auto const s : reordered.route_location_seq_[r]) {
+      auto const l_routes = reordered.location_routes_[stop{s}.location_idx()];
+      EXPECT_NE(end(l_routes), std::find(begin(l_routes), end(l_routes), r));
+    }
+  }
+
+  EXPECT_EQ(search(tt), search(reordered));
+}
+
+TEST(loader, reorder_locations) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto reordered = timetable{};
+  reordered.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd_5_20_26, files_abc(), reordered);
+  finalize(reordered, finalize_options{.reorder_locations_ = true,
+                                       .reorder_routes_ = true});
+
+  ASSERT_EQ(tt.n_locations(), reordered.n_locations());
+
+  // External ids resolve to the same station (name, position, footpaths).
+  for (auto const& [id, l] : tt.locations_.location_id_to_idx_) {
+    auto const new_l = reordered.locations_.location_id_to_idx_.at(id);
+    EXPECT_EQ(tt.locations_.ids_[l].view(),
+              reordered.locations_.ids_[new_l].view());
+    EXPECT_EQ(tt.locations_.names_[l].view(),
+              reordered.locations_.names_[new_l].view());
+    EXPECT_EQ(tt.locations_.coordinates_[l].lat_,
+              reordered.locations_.coordinates_[new_l].lat_);
+    EXPECT_EQ(tt.locations_.coordinates_[l].lng_,
+              reordered.locations_.coordinates_[new_l].lng_);
+    EXPECT_EQ(tt.location_routes_[l].size(),
+              reordered.location_routes_[new_l].size());
+
+    auto const fps = tt.locations_.footpaths_out_[0][l];
+    auto const new_fps = reordered.locations_.footpaths_out_[0][new_l];
+    ASSERT_EQ(fps.size(), new_fps.size());
+    for (auto i = 0U; i != fps.size(); ++i) {
+      EXPECT_EQ(tt.locations_.ids_[fps[i].target()].view(),
+                reordered.locations_.ids_[new_fps[i].target()].view());
+      EXPECT_EQ(fps[i].duration(), new_fps[i].duration());
+    }
+  }
+
+  // Route stops and location routes reference each other.
+  for (auto r = route_idx_t{0U}; r != reordered.n_routes(); ++r) {
+    for (auto const s : reordered.route_location_seq_[r]) {
+      auto const l_routes = reordered.location_routes_[stop{s}.location_idx()];
+      EXPECT_NE(end(l_routes), std::find(begin(l_routes), end(l_routes), r));
+    }
+  }
+
+  EXPECT_EQ(search(tt), search(reordered));
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+
+#include <random>
+
+#include "nigiri/common/perfect_hash.h"
+#include "nigiri/loader/gtfs/files.h"
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/timetable.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::loader::gtfs;
+using namespace date;
+
+namespace {
+
+mem_dir test_files() {
+  using std::filesystem::path;
+  return {
+      {{path{kAgencyFile},
+        std::string{
+            R"(agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+)"}},
+       {path{kStopFile},
+        std::string{
+            R"(stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,parent_station
+A,A,,0.0,1.0,,
+B,B,,2.0,3.0,,
+C,C,,4.0,5.0,,
+)"}},
+       {path{kCalendarDatesFile}, std::string{R"(service_id,date,exception_type
+S,20190503,1
+)"}},
+       {path{kRoutesFile},
+        std::string{
+            R"(route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+R1,DB,RE 1,,,3
+R2,DB,RE 2,,,3
+)"}},
+       {path{kTripsFile},
+        std::string{R"(route_id,service_id,trip_id,trip_headsign,block_id
+R1,S,T1,RE 1,
+R1,S,T2,RE 1,
+R2,S,T3,RE 2,
+R2,S,T4,RE 2,
+)"}},
+       {path{kStopTimesFile},
+        std::string{
+            R"(trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+T1,10:00:00,10:00:00,A,1,0,0
+T1,10:30:00,10:30:00,B,2,0,0
+T2,11:00:00,11:00:00,A,1,0,0
+T2,11:30:00,11:30:00,B,2,0,0
+T3,10:00:00,10:00:00,B,1,0,0
+T3,10:30:00,10:30:00,C,2,0,0
+T4,12:00:00,12:00:00,B,1,0,0
+T4,12:30:00,12:30:00,C,2,0,0
+)"}}}};
+}
+
+}  // namespace
+
+TEST(perfect_hash, random_keys) {
+  auto rng = std::mt19937_64{42U};
+  for (auto const n : {0U, 1U, 2U, 3U, 17U, 1000U, 50000U}) {
+    auto entries = std::vector<std::pair<std::uint64_t, std::uint32_t>>{};
+    for (auto i = 0U; i != n; ++i) {
+      entries.emplace_back(rng(), i);
+    }
+
+    auto idx = perfect_hash_index{};
+    ASSERT_TRUE(idx.build(entries));
+    ASSERT_EQ(n, idx.size());
+    for (auto const& [h, v] : entries) {
+      EXPECT_EQ(v, idx.find(h));
+    }
+  }
+}
+
+TEST(perfect_hash, duplicate_hashes) {
+  auto idx = perfect_hash_index{};
+  ASSERT_TRUE(idx.build({{1U, 0U}, {2U, 1U}}));
+  EXPECT_FALSE(idx.empty());
+
+  EXPECT_FALSE(idx.build({{1U, 0U}, {2U, 1U}, {1U, 2U}}));
+  EXPECT_TRUE(idx.empty());
+}
+
+TEST(perfect_hash, trip_id_index) {
+  auto tt = timetable{};
+  tt.date_range_ = {sys_days{2019_y / May / 1}, sys_days{2019_y / May / 7}};
+  load_timetable({}, source_idx_t{0}, test_files(), tt);
+  finalize(tt);
+
+  ASSERT_FALSE(tt.trip_id_index_.empty());
+
+  auto const check = [&]() {
+    for (auto const id : {"T1", "T2", "T3", "T4"}) {
+      auto const it = tt.find_trip_id(source_idx_t{0}, id);
+      ASSERT_NE(end(tt.trip_id_to_idx_), it);
+      EXPECT_EQ(id, tt.trip_id_strings_[it->first].view());
+      EXPECT_TRUE(it == begin(tt.trip_id_to_idx_) ||
+                  tt.trip_id_strings_[std::prev(it)->first].view() != id);
+    }
+    EXPECT_EQ(end(tt.trip_id_to_idx_), tt.find_trip_id(source_idx_t{0}, "X"));
+    EXPECT_EQ(end(tt.trip_id_to_idx_),
+              tt.find_trip_id(source_idx_t{1}, "T1"));
+  };
+
+  check();
+
+  // Timetables serialized without index or with colliding trip id hashes:
+  // binary search fallback.
+  tt.trip_id_index_ = perfect_hash_index{};
+  check();
+}
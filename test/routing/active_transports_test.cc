@@ -0,0 +1,140 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/raptor/active_transports.h"
+#include "nigiri/timetable.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::routing;
+using namespace date;
+
+namespace {
+
+// One route with 200 transports (more than one bitmap word) and different
+// traffic day patterns.
+mem_dir test_files() {
+  auto ss = std::stringstream{};
+  ss << R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+X,X,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,parent_station
+A,A,,0.0,1.0,,
+B,B,,2.0,3.0,,
+
+# calendar.txt
+service_id,monday,tuesday,wednesday,thursday,friday,saturday,sunday,start_date,end_date
+S0,1,1,1,1,1,0,0,20200330,20200412
+S1,0,0,0,0,0,1,1,20200330,20200412
+S2,1,1,1,1,1,1,1,20200330,20200412
+S3,0,0,1,0,0,0,0,20200330,20200412
+S4,0,0,0,0,0,0,0,20200330,20200412
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+R,X,R,,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+)";
+  for (auto i = 0U; i != 200U; ++i) {
+    ss << "R,S" << (i * 7U % 5U) << ",T" << i << ",B,\n";
+  }
+  ss << R"(
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+)";
+  for (auto i = 0U; i != 200U; ++i) {
+    auto const dep = 5U * 60U + i;
+    auto const arr = dep + 10U;
+    auto const hhmm = [](unsigned const m) {
+      auto out = std::stringstream{};
+      out << (m / 60U < 10U ? "0" : "") << m / 60U << ":"
+          << (m % 60U < 10U ? "0" : "") << m % 60U << ":00";
+      return out.str();
+    };
+    ss << "T" << i << "," << hhmm(dep) << "," << hhmm(dep) << ",A,1,0,0\n"
+       << "T" << i << "," << hhmm(arr) << "," << hhmm(arr) << ",B,2,0,0\n";
+  }
+  return mem_dir::read(ss.str());
+}
+
+timetable load() {
+  auto tt = timetable{};
+  tt.date_range_ = {sys_days{2020_y / March / 30},
+                    sys_days{2020_y / April / 13}};
+  register_special_stations(tt);
+  gtfs::load_timetable({}, source_idx_t{0}, test_files(), tt);
+  finalize(tt);
+  return tt;
+}
+
+}  // namespace
+
+TEST(active_transports, matches_bitfields) {
+  auto const tt = load();
+  auto at = active_transports{};
+
+  auto n_active = 0U;
+  for (auto r = route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const transports = tt.route_transport_ranges_[r];
+    for (auto day = 0U; day != 24U; ++day) {
+      auto const is_active = [&](transport_idx_t const t) {
+        return tt.bitfields_[tt.transport_traffic_days_[t]].test(day);
+      };
+
+      for (auto const t : transports) {
+        EXPECT_EQ(is_active(t), at.is_active(tt, r, t, day));
+        n_active += is_active(t) ? 1U : 0U;
+      }
+
+      for (auto from = transports.from_; from <= transports.to_; ++from) {
+        for (auto to = from; to <= transports.to_; ++to) {
+          auto first = to;
+          auto last = transport_idx_t::invalid();
+          for (auto t = from; t != to; ++t) {
+            if (is_active(t)) {
+              first = std::min(first, t);
+              last = t;
+            }
+          }
+          ASSERT_EQ(first, at.first_active(tt, r, from, to, day))
+              << "r=" << r << ", day=" << day << ", [" << from << ", " << to
+              << "[";
+          ASSERT_EQ(last, at.last_active(tt, r, from, to, day))
+              << "r=" << r << ", day=" << day << ", [" << from << ", " << to
+              << "[";
+        }
+      }
+    }
+  }
+  EXPECT_NE(0U, n_active);
+}
+
+TEST(active_transports, renew_id) {
+  auto tt = load();
+  auto at = active_transports{};
+
+  auto const t = transport_idx_t{0U};
+  auto const r = tt.transport_route_[t];
+  auto day = 0U;
+  while (day != kMaxDays &&
+         !tt.bitfields_[tt.transport_traffic_days_[t]].test(day)) {
+    ++day;
+  }
+  ASSERT_NE(kMaxDays, day);
+  ASSERT_TRUE(at.is_active(tt, r, t, day));
+
+  tt.transport_traffic_days_[t] = tt.register_bitfield(bitfield{});
+  tt.renew_id();
+  EXPECT_FALSE(at.is_active(tt, r, t, day));
+
+  // A new timetable never shares the id of an existing one.
+  EXPECT_NE(tt.id_, load().id_);
+}
@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/batch_search.h"
+
+#include "../loader/hrd/hrd_timetable.h"
+
+#include "../raptor_search.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::test_data::hrd_timetable;
+
+TEST(routing, batch_search) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = full_period();
+  load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const loc = [&](std::string_view id) {
+    return tt.locations_.location_id_to_idx_.at({id, src});
+  };
+  auto const make_query = [&](std::string_view from, std::string_view to,
+                              duration_t const from_h,
+                              duration_t const to_h) {
+    return routing::query{
+        .start_time_ =
+            interval{unixtime_t{sys_days{2020_y / March / 30}} + from_h,
+                     unixtime_t{sys_days{2020_y / March / 30}} + to_h},
+        .start_ = {{loc(from), 0_minutes, 0U}},
+        .destination_ = {{loc(to), 0_minutes, 0U}}};
+  };
+
+  auto const queries = std::vector<routing::query>{
+      make_query("0000001", "0000003", 5_hours, 6_hours),
+      make_query("0000002", "0000003", 5_hours, 7_hours),
+      make_query("0000001", "0000002", 5_hours, 6_hours),
+      make_query("0000001", "0000003", 4_hours, 5_hours)};
+
+  auto const results =
+      routing::raptor_batch_search(tt, nullptr, queries, direction::kForward);
+  ASSERT_EQ(queries.size(), results.size());
+
+  for (auto i = 0U; i != queries.size(); ++i) {
+    auto const expected = test::raptor_search(tt, nullptr, queries[i]);
+    EXPECT_EQ(expected.size(), results[i].journeys_.size());
+
+    auto expected_ss = std::stringstream{};
+    for (auto const& x : expected) {
+      x.print(expected_ss, tt);
+    }
+    auto batch_ss = std::stringstream{};
+    for (auto const& x : results[i].journeys_) {
+      x.print(batch_ss, tt);
+    }
+    EXPECT_EQ(expected_ss.str(), batch_ss.str());
+  }
+}
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "nigiri/loader/gtfs/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/timetable.h"
+
+#include "../raptor_search.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::test;
+using namespace date;
+
+namespace {
+
+mem_dir test_files() {
+  return mem_dir::read(R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+X,X,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,parent_station
+A,A,,0.0,1.0,,
+B,B,,2.0,3.0,,
+C,C,,4.0,5.0,,
+
+# calendar_dates.txt
+service_id,date,exception_type
+X,20200330,1
+X,20200331,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+X,X,X,,,1
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+X,X,X1,C,
+X,X,X2,A,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+X1,00:00:00,00:00:00,A,1,0,0
+X1,00:04:00,00:05:00,B,2,0,0
+X1,00:09:00,00:09:00,C,3,0,0
+X2,00:00:00,00:00:00,C,1,0,0
+X2,00:06:00,00:06:00,B,2,0,0
+X2,00:11:00,00:11:00,A,3,0,0
+
+# frequencies.txt
+trip_id,start_time,end_time,headway_secs
+X1,05:00:00,09:00:00,120
+X1,09:00:00,23:50:00,600
+X2,00:00:00,24:00:00,900
+)");
+}
+
+std::string search(timetable const& tt,
+                   std::string_view from,
+                   std::string_view to,
+                   direction const dir) {
+  auto const results = raptor_search(tt, nullptr, from, to, tt.date_range_,
+                                     dir, routing::all_clasz_allowed());
+  std::stringstream ss;
+  for (auto const& x : results) {
+    x.print(ss, tt);
+    ss << "\n";
+  }
+  return ss.str();
+}
+
+timetable load(finalize_options const& opt) {
+  auto tt = timetable{};
+  tt.date_range_ =
+      interval{sys_days{2020_y / March / 30}, sys_days{2020_y / April / 1}};
+  gtfs::load_timetable({}, source_idx_t{0}, test_files(), tt);
+  finalize(tt, opt);
+  return tt;
+}
+
+}  // namespace
+
+TEST(routing, frequency_runs) {
+  auto const tt = load({});
+  auto const tt_runs = load({.build_frequency_runs_ = true});
+
+  auto n_routes_with_runs = 0U;
+  for (auto r = route_idx_t{0U}; r != tt_runs.n_routes(); ++r) {
+    if (!tt_runs.has_frequency_runs(r)) {
+      continue;
+    }
+    ++n_routes_with_runs;
+    auto n_transports = 0U;
+    for (auto const& run : tt_runs.route_frequency_runs_[r]) {
+      EXPECT_EQ(n_transports, run.from_);
+      n_transports += run.n_;
+    }
+    EXPECT_EQ(static_cast<unsigned>(tt_runs.route_transport_ranges_[r].size()),
+              n_transports);
+  }
+  EXPECT_NE(0U, n_routes_with_runs);
+
+  for (auto const dir : {direction::kForward, direction::kBackward}) {
+    for (auto const [from, to] : {std::pair{"A", "C"}, std::pair{"C", "A"},
+                                  std::pair{"B", "A"}, std::pair{"A", "B"}}) {
+      auto const expected = search(tt, from, to, dir);
+      EXPECT_FALSE(expected.empty());
+      EXPECT_EQ(expected, search(tt_runs, from, to, dir));
+    }
+  }
+}
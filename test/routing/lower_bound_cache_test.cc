@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/dijkstra.h"
+#include "nigiri/routing/lower_bound_cache.h"
+
+#include "../loader/hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::test_data::hrd_timetable;
+
+TEST(routing, lower_bound_cache) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = full_period();
+  load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const make_query = [&](std::string_view dest) {
+    return routing::query{
+        .start_time_ = unixtime_t{sys_days{2020_y / March / 30}},
+        .destination_ = {
+            {tt.locations_.location_id_to_idx_.at({dest, src}), 0_minutes,
+             0U}}};
+  };
+  auto const q_c = make_query("0000003");
+  auto const q_b = make_query("0000002");
+
+  auto expected = std::vector<std::uint16_t>{};
+  routing::dijkstra(tt, q_c, tt.fwd_search_lb_graph_, expected);
+
+  auto cache = routing::lower_bound_cache{1U};
+  auto const a = cache.get_or_compute(tt, q_c, direction::kForward);
+  auto const b = cache.get_or_compute(tt, q_c, direction::kForward);
+  EXPECT_EQ(expected, *a);
+  EXPECT_EQ(a.get(), b.get());
+  EXPECT_EQ(1U, cache.size());
+
+  // Other direction and other destination are different keys.
+  auto const c = cache.get_or_compute(tt, q_c, direction::kBackward);
+  EXPECT_NE(a.get(), c.get());
+
+  // LRU eviction with max. size 1.
+  cache.get_or_compute(tt, q_b, direction::kForward);
+  EXPECT_EQ(1U, cache.size());
+  auto const d = cache.get_or_compute(tt, q_c, direction::kForward);
+  EXPECT_NE(a.get(), d.get());
+  EXPECT_EQ(expected, *d);
+
+  cache.clear();
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(routing, lower_bound_cache_reload) {
+  constexpr auto const src = source_idx_t{0U};
+
+  auto const load = [&](timetable& tt) {
+    tt.date_range_ = full_period();
+    load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+    finalize(tt);
+  };
+
+  auto tt = std::make_unique<timetable>();
+  load(*tt);
+
+  auto const q = routing::query{
+      .start_time_ = unixtime_t{sys_days{2020_y / March / 30}},
+      .destination_ = {
+          {tt->locations_.location_id_to_idx_.at({"0000003", src}), 0_minutes,
+           0U}}};
+
+  auto cache = routing::lower_bound_cache{4U};
+  auto const a = cache.get_or_compute(*tt, q, direction::kForward);
+  EXPECT_EQ(1U, cache.size());
+
+  // A reloaded timetable at the same address must not hit old entries.
+  auto const addr = tt.get();
+  std::destroy_at(addr);
+  std::construct_at(addr);
+  load(*tt);
+
+  auto const b = cache.get_or_compute(*tt, q, direction::kForward);
+  EXPECT_NE(a.get(), b.get());
+  EXPECT_EQ(*a, *b);
+  EXPECT_EQ(1U, cache.size());
+}
@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <utility>
+
+#include "nigiri/routing/journey.h"
+#include "nigiri/routing/pareto_set.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::routing;
+
+namespace {
+
+bool is_pareto_optimal(std::vector<journey> const& all, journey const& j) {
+  return std::none_of(begin(all), end(all), [&](journey const& o) {
+    return o.dominates(j) && !j.dominates(o);
+  });
+}
+
+}  // namespace
+
+TEST(routing, pareto_set_matches_brute_force) {
+  auto const base = unixtime_t{sys_days{2024_y / June / 10}};
+
+  auto rng = std::mt19937{42U};
+  auto transfers = std::uniform_int_distribution<unsigned>{0U, 5U};
+  auto minutes = std::uniform_int_distribution<int>{0, 240};
+
+  for (auto run = 0U; run != 50U; ++run) {
+    auto all = std::vector<journey>{};
+    auto s = pareto_set<journey>{};
+    for (auto i = 0U; i != 100U; ++i) {
+      auto const start = base + i32_minutes{minutes(rng)};
+      auto j = journey{
+          .start_time_ = start,
+          .dest_time_ = start + i32_minutes{30 + minutes(rng)},
+          .transfers_ = static_cast<std::uint8_t>(transfers(rng))};
+      all.push_back(j);
+
+      auto const [optimal, it, dominated_by] = s.add(std::move(j));
+      if (optimal) {
+        EXPECT_EQ(all.back().dest_time_, it->dest_time_);
+        EXPECT_EQ(dominated_by, end(s));
+      } else {
+        EXPECT_EQ(it, end(s));
+        EXPECT_TRUE(dominated_by->dominates(all.back()));
+      }
+    }
+
+    EXPECT_TRUE(std::is_sorted(
+        begin(s), end(s), [](journey const& a, journey const& b) {
+          return std::tie(a.transfers_, a.dest_time_) <
+                 std::tie(b.transfers_, b.dest_time_);
+        }));
+    for (auto const& j : s) {
+      EXPECT_TRUE(is_pareto_optimal(all, j));
+    }
+    for (auto const& j : all) {
+      if (is_pareto_optimal(all, j)) {
+        EXPECT_TRUE(std::any_of(begin(s), end(s), [&](journey const& x) {
+          return x.dominates(j);
+        }));
+      }
+    }
+  }
+}
+
+TEST(routing, pareto_set_sort_for_output) {
+  auto const base = unixtime_t{sys_days{2024_y / June / 10}};
+
+  auto s = pareto_set<journey>{};
+  auto const add = [&](int const start, int const dest,
+                       std::uint8_t const transfers) {
+    s.add(journey{.start_time_ = base + i32_minutes{start},
+                  .dest_time_ = base + i32_minutes{dest},
+                  .transfers_ = transfers});
+  };
+  auto const transfers = [&]() {
+    auto t = std::vector<unsigned>{};
+    for (auto const& j : std::as_const(s)) {
+      t.push_back(j.transfers_);
+    }
+    return t;
+  };
+
+  add(0, 120, 2U);
+  add(0, 150, 1U);
+  add(10, 200, 0U);
+  EXPECT_EQ((std::vector<unsigned>{0U, 1U, 2U}), transfers());
+
+  // Insertion order.
+  s.sort();
+  EXPECT_EQ((std::vector<unsigned>{2U, 1U, 0U}), transfers());
+
+  // Equal start times keep the insertion order.
+  s.sort([](journey const& a, journey const& b) {
+    return a.start_time_ > b.start_time_;
+  });
+  EXPECT_EQ((std::vector<unsigned>{0U, 2U, 1U}), transfers());
+
+  // Adding restores the internal order.
+  add(5, 100, 3U);
+  EXPECT_EQ((std::vector<unsigned>{0U, 1U, 2U, 3U}), transfers());
+
+  s.erase_if([](journey const& j) { return j.transfers_ == 1U; });
+  s.sort();
+  EXPECT_EQ((std::vector<unsigned>{2U, 0U, 3U}), transfers());
+}
+
+TEST(routing, pareto_set_mutable_access) {
+  auto const base = unixtime_t{sys_days{2024_y / June / 10}};
+
+  auto s = pareto_set<journey>{};
+  auto const add = [&](int const start, int const dest,
+                       std::uint8_t const transfers) {
+    s.add(journey{.start_time_ = base + i32_minutes{start},
+                  .dest_time_ = base + i32_minutes{dest},
+                  .transfers_ = transfers});
+  };
+  auto const transfers = [&]() {
+    auto t = std::vector<unsigned>{};
+    for (auto const& j : std::as_const(s)) {
+      t.push_back(j.transfers_);
+    }
+    return t;
+  };
+
+  add(0, 120, 2U);
+  add(0, 150, 1U);
+  add(10, 200, 0U);
+
+  // Order set through iterators is kept by sort().
+  std::sort(begin(s), end(s), [](journey const& a, journey const& b) {
+    return a.transfers_ > b.transfers_;
+  });
+  s.erase(begin(s));
+  s.sort();
+  EXPECT_EQ((std::vector<unsigned>{1U, 0U}), transfers());
+
+  // Adding restores the internal order.
+  add(5, 100, 3U);
+  EXPECT_EQ((std::vector<unsigned>{0U, 1U, 3U}), transfers());
+  s.sort();
+  EXPECT_EQ((std::vector<unsigned>{1U, 0U, 3U}), transfers());
+}
@@ -2,6 +2,7 @@
 
 #include "nigiri/loader/hrd/load_timetable.h"
 #include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/raptor_search.h"
 
 #include "../loader/hrd/hrd_timetable.h"
 
@@ -66,6 +67,76 @@ TEST(routing, raptor_forward) {
   EXPECT_EQ(std::string_view{fwd_journeys}, ss.str());
 }
 
+TEST(routing, raptor_forward_parallel_range) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = full_period();
+  load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto s_state = routing::search_state{};
+  auto r_state = routing::raptor_state{};
+  auto worker_states = std::vector<routing::raptor_state>(3U);
+  auto const q = routing::query{
+      .start_time_ =
+          interval{unixtime_t{sys_days{2020_y / March / 30}} + 5_hours,
+                   unixtime_t{sys_days{2020_y / March / 30}} + 6_hours},
+      .start_ = {{tt.locations_.location_id_to_idx_.at({"0000001", src}),
+                  0_minutes, 0U}},
+      .destination_ = {{tt.locations_.location_id_to_idx_.at({"0000003", src}),
+                        0_minutes, 0U}}};
+  auto const results = *routing::raptor_search(tt, nullptr, s_state, r_state,
+                                                q, direction::kForward,
+                                                std::nullopt, worker_states)
+                            .journeys_;
+
+  std::stringstream ss;
+  ss << "\n";
+  for (auto const& x : results) {
+    x.print(ss, tt);
+    ss << "\n\n";
+  }
+  EXPECT_EQ(std::string_view{fwd_journeys}, ss.str());
+}
+
+TEST(routing, raptor_forward_recorded_predecessors) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = full_period();
+  load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto s_state = routing::search_state{};
+  auto r_state = routing::raptor_state{};
+  auto const q = routing::query{
+      .start_time_ =
+          interval{unixtime_t{sys_days{2020_y / March / 30}} + 5_hours,
+                   unixtime_t{sys_days{2020_y / March / 30}} + 6_hours},
+      .start_ = {{tt.locations_.location_id_to_idx_.at({"0000001", src}),
+                  0_minutes, 0U}},
+      .destination_ = {{tt.locations_.location_id_to_idx_.at({"0000003", src}),
+                        0_minutes, 0U}},
+      .record_predecessors_ = true};
+  auto const result = routing::raptor_search(tt, nullptr, s_state, r_state, q,
+                                             direction::kForward);
+  auto const& results = *result.journeys_;
+  EXPECT_TRUE(r_state.has_predecessors());
+
+  // Transport legs were found through the recorded predecessors (not only
+  // through the fallback scan).
+  EXPECT_NE(0U, result.algo_stats_.n_reconstruct_recorded_hits_);
+
+  std::stringstream ss;
+  ss << "\n";
+  for (auto const& x : results) {
+    x.print(ss, tt);
+    ss << "\n\n";
+  }
+  EXPECT_EQ(std::string_view{fwd_journeys}, ss.str());
+}
+
 constexpr auto const bwd_journeys = R"(
 [2020-03-30 03:00, 2020-03-30 05:15]
 TRANSFERS: 1
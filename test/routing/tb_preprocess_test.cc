@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/tb/preprocess.h"
+#include "nigiri/timetable.h"
+
+#include "../loader/hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::routing::tb;
+using namespace nigiri::test_data::hrd_timetable;
+
+TEST(routing, tb_preprocess) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = full_period();
+  load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const d = preprocess(tt);
+  ASSERT_EQ(tt.transport_traffic_days_.size(),
+            d.transport_first_segment_.size());
+  ASSERT_EQ(tt.n_routes(), d.fifo_routes_.size());
+
+  auto n_transfers = 0U;
+  for (auto t = 0U; t != tt.transport_traffic_days_.size(); ++t) {
+    auto const from = transport_idx_t{t};
+    auto const seq = tt.route_location_seq_[tt.transport_route_[from]];
+    for (auto i = stop_idx_t{0U}; i != seq.size(); ++i) {
+      for (auto const& x : d.segment_transfers_[d.get_segment(from, i)]) {
+        ++n_transfers;
+
+        auto const to_seq =
+            tt.route_location_seq_[tt.transport_route_[x.to_transport_]];
+        EXPECT_LT(x.to_stop_idx_, to_seq.size() - 1U);
+        EXPECT_TRUE(d.bitfields_[x.traffic_days_].any());
+
+        // Transfer is valid in time (same stop: at least transfer time).
+        auto const arr = tt.event_mam(from, i, event_type::kArr).count();
+        auto const dep =
+            tt.event_mam(x.to_transport_, x.to_stop_idx_, event_type::kDep)
+                .count();
+        EXPECT_LE(arr, x.day_offset_ * 1440 + dep);
+      }
+    }
+  }
+  EXPECT_NE(0U, n_transfers);
+}
@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/routing/raptor_search.h"
+#include "nigiri/routing/tb/preprocess.h"
+#include "nigiri/routing/tb/tb_search.h"
+#include "nigiri/timetable.h"
+
+#include "../loader/hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::routing;
+using namespace nigiri::test_data::hrd_timetable;
+
+namespace {
+
+std::string to_string(timetable const& tt, pareto_set<journey> const& x) {
+  std::stringstream ss;
+  ss << "\n";
+  for (auto const& j : x) {
+    j.print(ss, tt);
+    ss << "\n\n";
+  }
+  return ss.str();
+}
+
+void expect_same_journeys(timetable const& tt,
+                          tb::tb_data const& tbd,
+                          query const& q) {
+  auto s_state = search_state{};
+  auto r_state = raptor_state{};
+  auto const raptor_results = *raptor_search(tt, nullptr, s_state, r_state, q,
+                                             direction::kForward)
+                                   .journeys_;
+
+  auto q_state = tb::query_state{tbd};
+  auto const tb_results = *tb::tb_search(tt, s_state, q_state, q).journeys_;
+
+  EXPECT_NE(0U, raptor_results.size());
+  EXPECT_EQ(to_string(tt, raptor_results), to_string(tt, tb_results));
+}
+
+}  // namespace
+
+TEST(routing, tb_query_engine) {
+  constexpr auto const src = source_idx_t{0U};
+
+  timetable tt;
+  tt.date_range_ = full_period();
+  register_special_stations(tt);
+  load_timetable(src, loader::hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const tbd = tb::preprocess(tt);
+  auto const a = tt.locations_.location_id_to_idx_.at({"0000001", src});
+  auto const c = tt.locations_.location_id_to_idx_.at({"0000003", src});
+  auto const start_interval =
+      interval{unixtime_t{sys_days{2020_y / March / 30}} + 5_hours,
+               unixtime_t{sys_days{2020_y / March / 30}} + 6_hours};
+
+  {  // Station to station.
+    expect_same_journeys(tt, tbd,
+                         query{.start_time_ = start_interval,
+                               .start_ = {{a, 0_minutes, 0U}},
+                               .destination_ = {{c, 0_minutes, 0U}},
+                               .prf_idx_ = 0U,
+                               .via_stops_ = {}});
+  }
+
+  {  // Intermodal start and destination.
+    expect_same_journeys(
+        tt, tbd,
+        query{.start_time_ = start_interval,
+              .start_match_mode_ = location_match_mode::kIntermodal,
+              .dest_match_mode_ = location_match_mode::kIntermodal,
+              .start_ = {{a, 10_minutes, 99U}},
+              .destination_ = {{c, 15_minutes, 77U}},
+              .prf_idx_ = 0U,
+              .via_stops_ = {}});
+  }
+
+  {  // No transfers allowed.
+    auto s_state = search_state{};
+    auto q_state = tb::query_state{tbd};
+    auto const results =
+        *tb::tb_search(tt, s_state, q_state,
+                       query{.start_time_ = start_interval,
+                             .start_ = {{a, 0_minutes, 0U}},
+                             .destination_ = {{c, 0_minutes, 0U}},
+                             .max_transfers_ = 0U,
+                             .prf_idx_ = 0U,
+                             .via_stops_ = {}})
+             .journeys_;
+    EXPECT_EQ(0U, results.size());
+  }
+}
@@ -96,6 +96,38 @@ T5,15:00:00,15:00:00,C,2,0,0
 )");
 }
 
+// Intermodal query A -> C with time-dependent start and destination offsets.
+routing::query make_query(location_idx_t const A, location_idx_t const C) {
+  return routing::query{
+      .start_time_ = unixtime_t{sys_days{2024_y / June / 19}} + 7h,
+      .start_match_mode_ = routing::location_match_mode::kIntermodal,
+      .dest_match_mode_ = routing::location_match_mode::kIntermodal,
+      .use_start_footpaths_ = false,
+      .td_start_ =
+          {{{A,
+             {{.valid_from_ = sys_days{1970_y / January / 1},
+               .duration_ = footpath::kMaxDuration,
+               .transport_mode_id_ = 0},
+              {.valid_from_ = sys_days{2024_y / June / 19} + 7h + 30min,
+               .duration_ = 10min,
+               .transport_mode_id_ = 0},
+              {.valid_from_ = sys_days{2024_y / June / 19} + 7h + 45min,
+               .duration_ = footpath::kMaxDuration,
+               .transport_mode_id_ = 0}}}}},
+      .td_dest_ =
+          {{{C,
+             {{.valid_from_ = sys_days{1970_y / January / 1},
+               .duration_ = 10min,
+               .transport_mode_id_ = 0},
+              {.valid_from_ = sys_days{2024_y / June / 19} + 12h + 30min,
+               .duration_ = footpath::kMaxDuration,
+               .transport_mode_id_ = 0},
+              {.valid_from_ = sys_days{2024_y / June / 19} + 13h + 30min,
+               .duration_ = 10min,
+               .transport_mode_id_ = 0}}}}},
+      .prf_idx_ = 2U};
+}
+
 }  // namespace
 
 std::string to_string(timetable const& tt,
@@ -193,37 +225,7 @@ TEST(routing, td_footpath) {
   auto rtt = rt::create_rt_timetable(tt, sys_days{2024_y / June / 19});
 
   auto const run_search = [&]() {
-    return raptor_search(
-        tt, &rtt,
-        routing::query{
-            .start_time_ = unixtime_t{sys_days{2024_y / June / 19}} + 7h,
-            .start_match_mode_ = routing::location_match_mode::kIntermodal,
-            .dest_match_mode_ = routing::location_match_mode::kIntermodal,
-            .use_start_footpaths_ = false,
-            .td_start_ =
-                {{{A,
-                   {{.valid_from_ = sys_days{1970_y / January / 1},
-                     .duration_ = footpath::kMaxDuration,
-                     .transport_mode_id_ = 0},
-                    {.valid_from_ = sys_days{2024_y / June / 19} + 7h + 30min,
-                     .duration_ = 10min,
-                     .transport_mode_id_ = 0},
-                    {.valid_from_ = sys_days{2024_y / June / 19} + 7h + 45min,
-                     .duration_ = footpath::kMaxDuration,
-                     .transport_mode_id_ = 0}}}}},
-            .td_dest_ =
-                {{{C,
-                   {{.valid_from_ = sys_days{1970_y / January / 1},
-                     .duration_ = 10min,
-                     .transport_mode_id_ = 0},
-                    {.valid_from_ = sys_days{2024_y / June / 19} + 12h + 30min,
-                     .duration_ = footpath::kMaxDuration,
-                     .transport_mode_id_ = 0},
-                    {.valid_from_ = sys_days{2024_y / June / 19} + 13h + 30min,
-                     .duration_ = 10min,
-                     .transport_mode_id_ = 0}}}}},
-            .prf_idx_ = 2U},
-        direction::kForward);
+    return raptor_search(tt, &rtt, make_query(A, C), direction::kForward);
   };
 
   // Base: elevator available, no real-time information.
@@ -248,4 +250,52 @@ TEST(routing, td_footpath) {
       B1, unixtime_t{sys_days{2024_y / June / 19} + 9h + 25min}, 10min});
 
   EXPECT_EQ(kElevatorStartsWorkingAt1125, to_string(tt, run_search()));
-}
\ No newline at end of file
+}
+
+TEST(routing, td_footpath_static) {
+  constexpr auto const kProfile = profile_idx_t{2U};
+
+  timetable tt;
+  tt.date_range_ = {date::sys_days{2024_y / June / 18},
+                    date::sys_days{2024_y / June / 20}};
+  register_special_stations(tt);
+  load_timetable({}, source_idx_t{0}, test_files(), tt);
+  finalize(tt);
+
+  auto const A = tt.locations_.get({"A", {}}).l_;
+  auto const C = tt.locations_.get({"C", {}}).l_;
+  auto const B1 = tt.locations_.get({"B1", {}}).l_;
+  auto const B2 = tt.locations_.get({"B2", {}}).l_;
+
+  auto& l = tt.locations_;
+  l.footpaths_out_[kProfile].resize(tt.n_locations());
+  l.footpaths_in_[kProfile].resize(tt.n_locations());
+  l.footpaths_out_[kProfile][B1].push_back(footpath{B2, 20min});
+  l.footpaths_in_[kProfile][B2].push_back(footpath{B1, 20min});
+
+  auto const run_search = [&]() {
+    return raptor_search(tt, nullptr, make_query(A, C), direction::kForward);
+  };
+
+  EXPECT_EQ(kEverythingWorks, to_string(tt, run_search()));
+
+  // Static time-dependent footpaths without entries: elevator never works.
+  l.has_td_footpaths_out_[kProfile].resize(tt.n_locations());
+  l.has_td_footpaths_in_[kProfile].resize(tt.n_locations());
+  l.has_td_footpaths_out_[kProfile].set(B1, true);
+  l.has_td_footpaths_out_[kProfile].set(B2, true);
+  l.has_td_footpaths_in_[kProfile].set(B1, true);
+  l.has_td_footpaths_in_[kProfile].set(B2, true);
+  l.td_footpaths_out_[kProfile].resize(tt.n_locations());
+  l.td_footpaths_in_[kProfile].resize(tt.n_locations());
+
+  EXPECT_EQ(kElevatorOutOfOrder, to_string(tt, run_search()));
+
+  // Elevator available beginning with 11:25 with 10min footpath length.
+  l.td_footpaths_out_[kProfile][B1].push_back(td_footpath{
+      B2, unixtime_t{sys_days{2024_y / June / 19} + 9h + 25min}, 10min});
+  l.td_footpaths_in_[kProfile][B2].push_back(td_footpath{
+      B1, unixtime_t{sys_days{2024_y / June / 19} + 9h + 25min}, 10min});
+
+  EXPECT_EQ(kElevatorStartsWorkingAt1125, to_string(tt, run_search()));
+}
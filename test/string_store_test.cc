@@ -0,0 +1,34 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "nigiri/common/string_store.h"
+
+using namespace nigiri;
+
+TEST(string_store, compact) {
+  auto s = string_store<location_idx_t>{};
+  s.emplace_back(std::string_view{"Bus 42"});
+  s.emplace_back(std::string{"Hauptbahnhof"});
+  s.emplace_back(std::string_view{"Bus 42"});
+  s.emplace_back(std::string_view{""});
+  s.emplace_back(std::string_view{"Bus 42"});
+
+  ASSERT_EQ(5U, s.size());
+  EXPECT_EQ(5U, s.strings_.size());
+
+  s.compact();
+
+  ASSERT_EQ(5U, s.size());
+  EXPECT_EQ(3U, s.strings_.size());
+  EXPECT_EQ("Bus 42", s[location_idx_t{0U}].view());
+  EXPECT_EQ("Hauptbahnhof", s[location_idx_t{1U}].view());
+  EXPECT_EQ("Bus 42", s.at(location_idx_t{2U}).view());
+  EXPECT_EQ("", s[location_idx_t{3U}].view());
+  EXPECT_EQ("Bus 42", s[location_idx_t{4U}].view());
+  EXPECT_EQ(s.idx_[location_idx_t{0U}], s.idx_[location_idx_t{4U}]);
+
+  s.emplace_back(std::string_view{"Hauptbahnhof"});
+  EXPECT_EQ(6U, s.size());
+  EXPECT_EQ("Hauptbahnhof", s[location_idx_t{5U}].view());
+}
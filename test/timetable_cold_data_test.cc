@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/timetable.h"
+#include "nigiri/timetable_cold_data.h"
+
+#include "./loader/hrd/hrd_timetable.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::test_data::hrd_timetable;
+namespace fs = std::filesystem;
+
+TEST(timetable, hot_cold_split) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const hot_path = fs::temp_directory_path() / "hot_cold_split_hot.bin";
+  auto const cold_path = fs::temp_directory_path() / "hot_cold_split_cold.bin";
+  write_hot_cold(tt, hot_path, cold_path);
+
+  // Timetable is unchanged after writing.
+  ASSERT_NE(0U, tt.trip_display_names_.size());
+  ASSERT_NE(0U, tt.trip_debug_.size());
+
+  auto hot = timetable::read(hot_path);
+  EXPECT_EQ(0U, hot->trip_display_names_.size());
+  EXPECT_EQ(0U, hot->trip_debug_.size());
+  EXPECT_EQ(0U, hot->source_file_names_.size());
+  EXPECT_EQ(tt.route_stop_times_.size(), hot->route_stop_times_.size());
+
+  // Cold accessors of the hot timetable are safe (and empty).
+  auto const t0 = transport_idx_t{0U};
+  EXPECT_EQ("", hot->transport_name(t0));
+  EXPECT_EQ("", hot->dbg(t0).path_);
+
+  // The cold data file is read on first access.
+  auto const cold = lazy_cold_data{cold_path, *hot};
+  EXPECT_FALSE(cold.is_loaded());
+  EXPECT_EQ(tt.transport_name(t0), cold.transport_name(t0));
+  EXPECT_TRUE(cold.is_loaded());
+  EXPECT_EQ(0U, hot->trip_display_names_.size());
+
+  for (auto i = trip_idx_t{0U}; i != tt.trip_display_names_.size(); ++i) {
+    EXPECT_EQ(tt.trip_display_names_[i].view(), cold.trip_display_name(i));
+  }
+  for (auto t = transport_idx_t{0U}; t != tt.transport_route_.size(); ++t) {
+    EXPECT_EQ(tt.dbg(t).path_, cold.dbg(t).path_);
+    EXPECT_EQ(tt.dbg(t).line_from_, cold.dbg(t).line_from_);
+    EXPECT_EQ(tt.dbg(t).line_to_, cold.dbg(t).line_to_);
+  }
+
+  fs::remove(hot_path);
+  fs::remove(cold_path);
+}
@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/mapped_timetable.h"
+#include "nigiri/timetable.h"
+
+#include "./loader/hrd/hrd_timetable.h"
+
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::test_data::hrd_timetable;
+namespace fs = std::filesystem;
+
+TEST(timetable, read_options) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const path = fs::temp_directory_path() / "timetable_read_options.bin";
+  tt.write(path);
+
+  auto const read = timetable::read(
+      path, {.huge_pages_ = true, .prefault_ = true, .lock_ = true});
+  EXPECT_EQ(tt.n_routes(), read->n_routes());
+  EXPECT_EQ(tt.n_locations(), read->n_locations());
+  ASSERT_EQ(tt.route_stop_times_.size(), read->route_stop_times_.size());
+  for (auto i = 0U; i != tt.route_stop_times_.size(); ++i) {
+    EXPECT_EQ(tt.route_stop_times_[i], read->route_stop_times_[i]);
+  }
+
+  fs::remove(path);
+}
+
+TEST(timetable, mapped) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const path = fs::temp_directory_path() / "timetable_mapped.bin";
+  tt.write(path);
+
+  auto a = mapped_timetable{path, {.prefault_ = true}};
+  auto const b = mapped_timetable{path};
+  ASSERT_NE(a.get(), b.get());
+
+  auto const moved = std::move(a);
+  EXPECT_EQ(nullptr, a.get());
+  EXPECT_EQ(tt.n_routes(), moved->n_routes());
+  EXPECT_EQ(tt.n_routes(), b->n_routes());
+  ASSERT_EQ(tt.route_stop_times_.size(), b->route_stop_times_.size());
+  for (auto i = 0U; i != tt.route_stop_times_.size(); ++i) {
+    EXPECT_EQ(tt.route_stop_times_[i], moved->route_stop_times_[i]);
+    EXPECT_EQ(tt.route_stop_times_[i], b->route_stop_times_[i]);
+  }
+  for (auto l = location_idx_t{0U}; l != tt.n_locations(); ++l) {
+    EXPECT_EQ(tt.locations_.names_[l].view(), b->locations_.names_[l].view());
+  }
+
+  fs::remove(path);
+}
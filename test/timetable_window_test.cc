@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "nigiri/loader/hrd/load_timetable.h"
+#include "nigiri/loader/init_finish.h"
+#include "nigiri/timetable.h"
+#include "nigiri/timetable_window.h"
+
+#include "./loader/hrd/hrd_timetable.h"
+
+using namespace date;
+using namespace nigiri;
+using namespace nigiri::loader;
+using namespace nigiri::test_data::hrd_timetable;
+
+namespace {
+
+using run_t = std::pair<route_idx_t, std::vector<unixtime_t>>;
+
+// All transport runs starting within the given days.
+std::set<run_t> get_runs(timetable const& tt, interval<sys_days> const days) {
+  auto runs = std::set<run_t>{};
+  for (auto t = transport_idx_t{0U}; t != tt.transport_traffic_days_.size();
+       ++t) {
+    auto const r = tt.transport_route_[t];
+    auto const n_stops =
+        static_cast<stop_idx_t>(tt.route_location_seq_[r].size());
+    auto const& bf = tt.bitfields_[tt.transport_traffic_days_[t]];
+    for (auto i = 0U; i != kMaxDays; ++i) {
+      auto const d = day_idx_t{i};
+      if (!bf.test(i) ||
+          !days.contains(tt.internal_interval_days().from_ + date::days{i})) {
+        continue;
+      }
+      auto times = std::vector<unixtime_t>{};
+      for (auto i = stop_idx_t{0U}; i != n_stops; ++i) {
+        if (i != 0U) {
+          times.push_back(tt.event_time({t, d}, i, event_type::kArr));
+        }
+        if (i != n_stops - 1U) {
+          times.push_back(tt.event_time({t, d}, i, event_type::kDep));
+        }
+      }
+      runs.emplace(r, std::move(times));
+    }
+  }
+  return runs;
+}
+
+}  // namespace
+
+TEST(timetable, restrict_to_window) {
+  auto tt = timetable{};
+  tt.date_range_ = full_period();
+  load_timetable(source_idx_t{0U}, hrd::hrd_5_20_26, files_abc(), tt);
+  finalize(tt);
+
+  auto const rule_days = tt.transport_traffic_days_[transport_idx_t{0U}];
+  auto rule = booking_rule{};
+  rule.bitfield_idx_ = rule_days;
+  tt.booking_rules_.emplace_back(rule);
+
+  auto const window = interval<sys_days>{sys_days{2020_y / March / 30},
+                                         sys_days{2020_y / March / 31}};
+  auto windowed = tt;
+  restrict_to_window(windowed, window);
+
+  EXPECT_TRUE(window == windowed.date_range_);
+  EXPECT_LT(windowed.transport_traffic_days_.size(),
+            tt.transport_traffic_days_.size());
+  EXPECT_EQ(windowed.transport_traffic_days_.size(),
+            windowed.transport_route_.size());
+  EXPECT_EQ(windowed.route_stop_times_.size(),
+            windowed.route_stop_time_ranges_.back().to_);
+
+  auto const expected = get_runs(tt, windowed.internal_interval_days());
+  EXPECT_FALSE(expected.empty());
+  EXPECT_TRUE(expected ==
+              get_runs(windowed, windowed.internal_interval_days()));
+
+  for (auto const routes : windowed.location_routes_) {
+    for (auto const r : routes) {
+      auto const transports = windowed.route_transport_ranges_[r];
+      EXPECT_NE(transports.from_, transports.to_);
+    }
+  }
+
+  // Booking rule days are renumbered like all other bitfields.
+  auto const& windowed_days =
+      windowed.bitfields_[windowed.booking_rules_.back().bitfield_idx_];
+  auto const offset = static_cast<std::size_t>(
+      (windowed.internal_interval_days().from_ -
+       tt.internal_interval_days().from_)
+          .count());
+  auto const n_days = static_cast<std::size_t>(
+      windowed.internal_interval_days().size().count());
+  for (auto i = std::size_t{0U}; i != n_days; ++i) {
+    EXPECT_EQ(tt.bitfields_[rule_days].test(offset + i),
+              windowed_days.test(i));
+  }
+}